@@ -0,0 +1,80 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef TIME_SERIES_AGGREGATE_H
+#define TIME_SERIES_AGGREGATE_H
+
+#include <limits>
+
+#include "timeseriesarraytypes.h"
+
+namespace TimeSeries {
+
+struct TimeSeriesAggregate
+{
+    TimeSeriesAggregate() :
+        count(0),
+        sum(0.0),
+        min(std::numeric_limits<value_double>::infinity()),
+        max(-std::numeric_limits<value_double>::infinity())
+    {
+    }
+
+    void add(value_double value)
+    {
+        count++;
+        sum += value;
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+    }
+
+    void add(value_double value, size_t valueCount)
+    {
+        count += valueCount;
+        sum += value * valueCount;
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+    }
+
+    void merge(const TimeSeriesAggregate& other)
+    {
+        count += other.count;
+        sum += other.sum;
+        min = other.min < min ? other.min : min;
+        max = other.max > max ? other.max : max;
+    }
+
+    value_double mean() const
+    {
+        return count ? sum / count : 0.0;
+    }
+
+    size_t count;
+    value_double sum;
+    value_double min;
+    value_double max;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_AGGREGATE_H
@@ -23,10 +23,28 @@
 #ifndef TIME_SERIES_ARRAY_H
 #define TIME_SERIES_ARRAY_H
 
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include "timeseriesarraytypes.h"
+#include "timeseriesblockdecoder.h"
+#include "timeseriescoldcompactor.h"
+#include "timeseriescursor.h"
 #include "timeseriesdatacontainer.h"
 #include "timeseriesdataiterator.h"
 #include "timeseriesdatarange.h"
+#include "timeseriesmergeiterator.h"
+#include "timeseriespipeline.h"
+#include "timeseriesprefetchiterator.h"
+#include "timeseriesresampler.h"
+#include "timeseriessharedmemory.h"
+#include "timeseriessnapshot.h"
+#include "timeseriessubscription.h"
+#include "timeseriestimeunit.h"
+#include "timeseriesvertexwriter.h"
+#include "timeserieswriteaheadlog.h"
 
 namespace TimeSeries {
 
@@ -34,7 +52,22 @@ template <int BlockSize = 8192, bool Compress = true>
 class TimeSeriesArray
 {
 public:
-    TimeSeriesArray(time_s64 sizeMillis) : m_container(sizeMillis)
+    TimeSeriesArray(time_s64 sizeMillis) :
+        m_container(sizeMillis),
+        m_timeUnit(TimeSeriesTimeUnit::Milliseconds)
+    {
+    }
+
+    TimeSeriesArray(time_s64 size, TimeSeriesTimeUnit timeUnit) :
+        m_container(size),
+        m_timeUnit(timeUnit)
+    {
+    }
+
+    template <class Rep, class Period>
+    TimeSeriesArray(std::chrono::duration<Rep, Period> size, TimeSeriesTimeUnit timeUnit) :
+        m_container(toTimeUnits(size, timeUnit)),
+        m_timeUnit(timeUnit)
     {
     }
 
@@ -42,9 +75,101 @@ public:
     {
     }
 
+    TimeSeriesTimeUnit timeUnit() const
+    {
+        return m_timeUnit;
+    }
+
+    template <class Rep, class Period>
+    time_s64 toTime(std::chrono::duration<Rep, Period> duration) const
+    {
+        return toTimeUnits(duration, m_timeUnit);
+    }
+
     void append(time_s64 time, value_double value)
     {
         m_container.append(time, value);
+        if (m_sharedMemory)
+        {
+            m_sharedMemory->append(m_container);
+        }
+    }
+
+    bool enableWriteAheadLog(const char* path, int commitIntervalMillis = 10,
+                             TimeSeriesSyncPolicy syncPolicy = TimeSeriesSyncPolicy::Interval,
+                             int syncIntervalMillis = 1000)
+    {
+        m_writeAheadLog.reset();
+
+        std::vector<TimeSeriesDataBlock<BlockSize, Compress>*> blocks;
+        if (TimeSeriesWriteAheadLog<BlockSize, Compress>::replay(path, blocks) < 0 ||
+            !m_container.insertBlocks(blocks, true))
+        {
+            for (const auto block : blocks)
+            {
+                delete block;
+            }
+            return false;
+        }
+        publishSharedMemory();
+
+        m_writeAheadLog.reset(new TimeSeriesWriteAheadLog<BlockSize, Compress>(&m_container));
+        if (!m_writeAheadLog->open(path, commitIntervalMillis, syncPolicy, syncIntervalMillis))
+        {
+            m_writeAheadLog.reset();
+            return false;
+        }
+        return true;
+    }
+
+    bool flushWriteAheadLog()
+    {
+        return m_writeAheadLog && m_writeAheadLog->flush();
+    }
+
+    void disableWriteAheadLog()
+    {
+        m_writeAheadLog.reset();
+    }
+
+    bool enableSharedMemory(const char* name, int slotCount, int publishInterval = 1024)
+    {
+        m_sharedMemory.reset(new TimeSeriesSharedMemoryWriter<BlockSize, Compress>());
+        if (!m_sharedMemory->create(name, slotCount, publishInterval))
+        {
+            m_sharedMemory.reset();
+            return false;
+        }
+        m_sharedMemory->publish(m_container);
+        return true;
+    }
+
+    void publishSharedMemory()
+    {
+        if (m_sharedMemory)
+        {
+            m_sharedMemory->publish(m_container);
+        }
+    }
+
+    void disableSharedMemory()
+    {
+        m_sharedMemory.reset();
+    }
+
+    void enableColdTier(time_s64 age, int intervalMillis = 1000)
+    {
+        m_coldCompactor.reset(new TimeSeriesColdCompactor<BlockSize, Compress>(&m_container, age, intervalMillis));
+    }
+
+    void disableColdTier()
+    {
+        m_coldCompactor.reset();
+    }
+
+    int recompress(time_s64 age)
+    {
+        return m_container.recompress(age);
     }
 
     TimeSeriesDataIterator<BlockSize, Compress> iter() const
@@ -54,7 +179,231 @@ public:
 
     TimeSeriesDataRange<BlockSize, Compress> range(time_s64 beginTime = 0, time_s64 endTime = -1) const
     {
-        return TimeSeriesDataRange<BlockSize, Compress>(&m_container, beginTime, endTime);
+        return TimeSeriesDataRange<BlockSize, Compress>(&m_container, beginTime, endTime, m_timeUnit);
+    }
+
+    TimeSeriesPrefetchIterator<BlockSize, Compress> prefetchIter(time_s64 beginTime = 0, time_s64 endTime = -1,
+                                                                  bool useHelperThread = false) const
+    {
+        return TimeSeriesPrefetchIterator<BlockSize, Compress>(&m_container, beginTime, endTime, useHelperThread);
+    }
+
+    TimeSeriesCursor cursor(time_s64 beginTime = 0, time_s64 endTime = -1)
+    {
+        return TimeSeriesCursorReader<BlockSize, Compress>(&m_container).seek(beginTime, endTime);
+    }
+
+    int read(TimeSeriesCursor& cursor, time_s64* times, value_double* values, int capacity)
+    {
+        return TimeSeriesCursorReader<BlockSize, Compress>(&m_container).read(cursor, times, values, capacity);
+    }
+
+    TimeSeriesSnapshot<BlockSize, Compress> snapshot()
+    {
+        return TimeSeriesSnapshot<BlockSize, Compress>(&m_container);
+    }
+
+    TimeSeriesSubscription<BlockSize, Compress> subscribe(time_s64 fromTime = 0, int notifyCount = 1) const
+    {
+        return TimeSeriesSubscription<BlockSize, Compress>(&m_container, fromTime, notifyCount);
+    }
+
+    int emitVertices(time_s64 beginTime, time_s64 endTime,
+                     time_s64 originTime, float timeScale,
+                     value_double valueOffset, float valueScale,
+                     float* out, int capacity, time_s64 bucketTime = 0) const
+    {
+        TimeSeriesVertexWriter<BlockSize, Compress> writer(&m_container, originTime, timeScale,
+                                                           valueOffset, valueScale);
+        if (bucketTime > 0)
+        {
+            return writer.writeMinMax(beginTime, endTime, bucketTime, out, capacity);
+        }
+        return writer.write(beginTime, endTime, out, capacity);
+    }
+
+    static TimeSeriesMergeIterator<BlockSize, Compress> merge(const TimeSeriesArray* const* arrays,
+                                                              int arrayCount, TimeSeriesJoin join,
+                                                              time_s64 beginTime = 0,
+                                                              time_s64 endTime = -1)
+    {
+        std::vector<const TimeSeriesDataContainer<BlockSize, Compress>*> containers(arrayCount);
+        for (int index = 0; index < arrayCount; ++index)
+        {
+            containers[index] = &arrays[index]->m_container;
+        }
+        return TimeSeriesMergeIterator<BlockSize, Compress>(containers.data(), arrayCount, join,
+                                                            beginTime, endTime);
+    }
+
+    void setErrorBound(TimeSeriesErrorBound errorBound, value_double bound)
+    {
+        m_container.setErrorBound(errorBound, bound);
+    }
+
+    void setMemoryBudget(size_t memoryBudget)
+    {
+        m_container.setMemoryBudget(memoryBudget);
+    }
+
+    void compact()
+    {
+        m_container.compact();
+    }
+
+    bool compactIdle(time_s64 currentTime, time_s64 idleTime)
+    {
+        return m_container.compactIdle(currentTime, idleTime);
+    }
+
+    void enableBlockCache(int blockCount)
+    {
+        m_container.enableBlockCache(blockCount);
+    }
+
+    size_t blockCacheHits() const
+    {
+        return m_container.blockCache() ? m_container.blockCache()->hitCount() : 0;
+    }
+
+    size_t blockCacheMisses() const
+    {
+        return m_container.blockCache() ? m_container.blockCache()->missCount() : 0;
+    }
+
+    TimeSeriesAggregate aggregate(time_s64 beginTime = 0, time_s64 endTime = -1) const
+    {
+        return m_container.aggregate(beginTime, endTime);
+    }
+
+    size_t resample(time_s64 beginTime, time_s64 endTime, time_s64 step,
+                    TimeSeriesFill fill, TimeSeriesCellAggregate aggregate, value_double* out) const
+    {
+        TimeSeriesResampler<BlockSize, Compress> resampler(&m_container);
+        return resampler.resample(beginTime, endTime, step, fill, aggregate, out);
+    }
+
+    size_t count() const
+    {
+        return m_container.count();
+    }
+
+    size_t count(time_s64 beginTime, time_s64 endTime) const
+    {
+        if (m_container.blockCount() == 0 || (endTime >= 0 && endTime < beginTime))
+        {
+            return 0;
+        }
+
+        const value_u64 beginOrdinal = ordinalOf(beginTime, false);
+        const value_u64 endOrdinal = endTime < 0 ? m_container.count() : ordinalOf(endTime, true);
+        return endOrdinal > beginOrdinal ? static_cast<size_t>(endOrdinal - beginOrdinal) : 0;
+    }
+
+    bool at(size_t ordinal, time_s64& time, value_double& value) const
+    {
+        return read(ordinal, &time, &value, 1) == 1;
+    }
+
+    int read(size_t ordinal, time_s64* times, value_double* values, int capacity) const
+    {
+        int readCount = 0;
+        if (ordinal >= m_container.count())
+        {
+            return readCount;
+        }
+
+        const value_u64 firstOrdinal = m_container.firstOrdinal() + ordinal;
+        int blockIndex = m_container.findOrdinal(firstOrdinal);
+        int sampleIndex = static_cast<int>(firstOrdinal - m_container.blockInfo(blockIndex).ordinal);
+
+        TimeSeriesBlockDecoder<BlockSize, Compress> decoder;
+        while (readCount < capacity && blockIndex < m_container.blockCount())
+        {
+            const int count = std::min(decoder.decode(&m_container, blockIndex) - sampleIndex, capacity - readCount);
+            std::copy(decoder.times() + sampleIndex, decoder.times() + sampleIndex + count, times + readCount);
+            std::copy(decoder.values() + sampleIndex, decoder.values() + sampleIndex + count, values + readCount);
+            readCount += count;
+            sampleIndex = 0;
+            ++blockIndex;
+        }
+
+        return readCount;
+    }
+
+    bool load(const time_s64* times, const value_double* values, size_t count, int threadCount = 0)
+    {
+        if (count > 0 && !m_container.isRetained(times[0], times[count - 1]))
+        {
+            return false;
+        }
+
+        std::vector<value_double> quantized;
+        if (m_container.errorBound() != TimeSeriesErrorBound::None)
+        {
+            quantized.resize(count);
+            for (size_t index = 0; index < count; ++index)
+            {
+                quantized[index] = m_container.quantize(values[index]);
+            }
+            values = quantized.data();
+        }
+
+        if (threadCount <= 0)
+        {
+            threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+        const size_t threadChunkSize = (count + threadCount - 1) / threadCount;
+        const size_t chunkSize = threadChunkSize > LoadChunkSize ? threadChunkSize : LoadChunkSize;
+        const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+        std::vector<std::vector<TimeSeriesDataBlock<BlockSize, Compress>*>> chunkBlocks(chunkCount);
+        std::vector<std::thread> threads;
+
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            threads.emplace_back([&, chunk]() {
+                const size_t begin = chunk * chunkSize;
+                TimeSeriesDataContainer<BlockSize, Compress>::buildBlocks(times + begin, values + begin,
+                                                                          std::min(chunkSize, count - begin),
+                                                                          chunkBlocks[chunk]);
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        std::vector<TimeSeriesDataBlock<BlockSize, Compress>*> blocks;
+        bool isSorted = true;
+        for (const auto& chunk : chunkBlocks)
+        {
+            for (const auto block : chunk)
+            {
+                isSorted &= blocks.empty() || blocks.back()->endTime() < block->beginTime();
+                blocks.push_back(block);
+            }
+        }
+
+        if (!isSorted || !m_container.insertBlocks(blocks, false))
+        {
+            for (const auto block : blocks)
+            {
+                delete block;
+            }
+            return false;
+        }
+
+        if (m_writeAheadLog && count > 0)
+        {
+            m_writeAheadLog->logRange(times[0], times[count - 1]);
+        }
+
+        if (m_sharedMemory)
+        {
+            m_sharedMemory->publish(m_container);
+        }
+        return true;
     }
 
     size_t dataSize() const
@@ -62,8 +411,43 @@ public:
         return m_container.dataSize();
     }
 
+    TimeSeriesArrayStats stats() const
+    {
+        return m_container.stats();
+    }
+
 private:
+    static const size_t LoadChunkSize = 1 << 16;
+
+    value_u64 ordinalOf(time_s64 time, bool isInclusive) const
+    {
+        const int blockIndex = m_container.findBlock(time);
+        const TimeSeriesBlockInfo info = m_container.blockInfo(blockIndex);
+
+        const value_u64 ordinal = info.ordinal - m_container.firstOrdinal();
+
+        if (time < info.beginTime || (time == info.beginTime && !isInclusive))
+        {
+            return ordinal;
+        }
+        if (time > info.endTime || (time == info.endTime && isInclusive))
+        {
+            return ordinal + info.count;
+        }
+
+        TimeSeriesBlockDecoder<BlockSize, Compress> decoder;
+        const int count = decoder.decode(&m_container, blockIndex);
+        const time_s64* times = decoder.times();
+        const time_s64* bound = isInclusive ? std::upper_bound(times, times + count, time)
+                                            : std::lower_bound(times, times + count, time);
+        return ordinal + (bound - times);
+    }
+
     TimeSeriesDataContainer<BlockSize, Compress> m_container;
+    TimeSeriesTimeUnit m_timeUnit;
+    std::unique_ptr<TimeSeriesWriteAheadLog<BlockSize, Compress>> m_writeAheadLog;
+    std::unique_ptr<TimeSeriesSharedMemoryWriter<BlockSize, Compress>> m_sharedMemory;
+    std::unique_ptr<TimeSeriesColdCompactor<BlockSize, Compress>> m_coldCompactor;
 };
 
 } // namespace TimeSeries
@@ -0,0 +1,66 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef TIME_SERIES_ARRAY_STATS_H
+#define TIME_SERIES_ARRAY_STATS_H
+
+#include "timeseriesarraytypes.h"
+#include "timeseriesquantizer.h"
+
+namespace TimeSeries {
+
+struct TimeSeriesArrayStats
+{
+    TimeSeriesArrayStats() :
+        blockCount(0),
+        coldBlockCount(0),
+        sampleCount(0),
+        dataSize(0),
+        memorySize(0),
+        beginTime(0),
+        endTime(0),
+        compressionRatio(0.0),
+        errorBound(TimeSeriesErrorBound::None),
+        bound(0.0),
+        maxAbsoluteError(0.0),
+        maxRelativeError(0.0)
+    {
+    }
+
+    int blockCount;
+    int coldBlockCount;
+    size_t sampleCount;
+    size_t dataSize;
+    size_t memorySize;
+    time_s64 beginTime;
+    time_s64 endTime;
+    value_double compressionRatio;
+    TimeSeriesErrorBound errorBound;
+    value_double bound;
+    value_double maxAbsoluteError;
+    value_double maxRelativeError;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_ARRAY_STATS_H
@@ -23,13 +23,20 @@
 #ifndef TIME_SERIES_ARRAY_TYPES_H
 #define TIME_SERIES_ARRAY_TYPES_H
 
+#include <cstddef>
+#include <cstring>
+
 namespace TimeSeries {
 
 typedef signed long long time_s64;
 typedef unsigned long long time_u64;
 typedef unsigned int time_u32;
 
+typedef signed long long sequence_s64;
+
 typedef unsigned long long value_u64;
+typedef unsigned int value_u32;
+typedef unsigned short value_u16;
 typedef unsigned char value_u8;
 typedef double value_double;
 
@@ -37,10 +44,23 @@ static_assert(sizeof(time_s64) == 8, "sizeof(time_s64) != 8");
 static_assert(sizeof(time_u64) == 8, "sizeof(time_u64) != 8");
 static_assert(sizeof(time_u32) == 4, "sizeof(time_u32) != 4");
 
+static_assert(sizeof(sequence_s64) == 8, "sizeof(sequence_s64) != 8");
+
 static_assert(sizeof(value_u64) == 8, "sizeof(value_u64) != 8");
+static_assert(sizeof(value_u32) == 4, "sizeof(value_u32) != 4");
+static_assert(sizeof(value_u16) == 2, "sizeof(value_u16) != 2");
 static_assert(sizeof(value_u8) == 1, "sizeof(value_u8) != 1");
 static_assert(sizeof(value_double) == 8, "sizeof(value_double) != 8");
 
+template <class To, class From>
+inline To bitCast(const From& from)
+{
+    static_assert(sizeof(To) == sizeof(From), "sizeof(To) != sizeof(From)");
+    To to;
+    std::memcpy(&to, &from, sizeof(To));
+    return to;
+}
+
 } // namespace TimeSeries
 
 #endif // TIME_SERIES_ARRAY_TYPES_H
@@ -0,0 +1,207 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef TIME_SERIES_BLOCK_CACHE_H
+#define TIME_SERIES_BLOCK_CACHE_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "timeseriesarraytypes.h"
+#include "timeseriesdatablock.h"
+
+namespace TimeSeries {
+
+template <int BlockSize>
+class TimeSeriesDecodedBlock
+{
+public:
+    TimeSeriesDecodedBlock() :
+        m_sequence(-1),
+        m_extent(0),
+        m_count(0)
+    {
+    }
+
+    int decode(sequence_s64 sequence, const TimeSeriesDataBlock<BlockSize, true>* block)
+    {
+        m_sequence = sequence;
+        m_extent = block->committedExtent();
+        m_count = block->read(m_times, m_values);
+        return m_count;
+    }
+
+    sequence_s64 sequence() const
+    {
+        return m_sequence;
+    }
+
+    value_u64 extent() const
+    {
+        return m_extent;
+    }
+
+    int count() const
+    {
+        return m_count;
+    }
+
+    const time_s64* times() const
+    {
+        return m_times;
+    }
+
+    const value_u64* values() const
+    {
+        return m_values;
+    }
+
+private:
+    sequence_s64 m_sequence;
+    value_u64 m_extent;
+    int m_count;
+    time_s64 m_times[TimeSeriesDataBlock<BlockSize, true>::MaxCount];
+    value_u64 m_values[TimeSeriesDataBlock<BlockSize, true>::MaxCount];
+};
+
+template <int BlockSize>
+class TimeSeriesBlockCache
+{
+public:
+    typedef std::shared_ptr<const TimeSeriesDecodedBlock<BlockSize>> Entry;
+
+    TimeSeriesBlockCache(int capacity) :
+        m_capacity(capacity > 0 ? capacity : 1),
+        m_hitCount(0),
+        m_missCount(0)
+    {
+    }
+
+    ~TimeSeriesBlockCache() = default;
+
+    Entry get(sequence_s64 sequence, const TimeSeriesDataBlock<BlockSize, true>* block)
+    {
+        std::shared_ptr<TimeSeriesDecodedBlock<BlockSize>> spare;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto found = m_entries.find(sequence);
+
+            if (found != m_entries.end())
+            {
+                if ((*found->second)->extent() == block->committedExtent())
+                {
+                    m_lru.splice(m_lru.begin(), m_lru, found->second);
+                    ++m_hitCount;
+                    return *found->second;
+                }
+
+                removeLocked(found);
+            }
+
+            ++m_missCount;
+            spare.swap(m_spare);
+        }
+
+        if (!spare)
+        {
+            spare = std::make_shared<TimeSeriesDecodedBlock<BlockSize>>();
+        }
+        spare->decode(sequence, block);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_entries.find(sequence);
+
+        if (found != m_entries.end())
+        {
+            removeLocked(found);
+        }
+
+        m_lru.push_front(spare);
+        m_entries[sequence] = m_lru.begin();
+
+        while (static_cast<int>(m_lru.size()) > m_capacity)
+        {
+            removeLocked(m_entries.find(m_lru.back()->sequence()));
+        }
+
+        return spare;
+    }
+
+    void invalidate(sequence_s64 sequence)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_entries.find(sequence);
+
+        if (found != m_entries.end())
+        {
+            removeLocked(found);
+        }
+    }
+
+    int capacity() const
+    {
+        return m_capacity;
+    }
+
+    size_t hitCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_hitCount;
+    }
+
+    size_t missCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_missCount;
+    }
+
+private:
+    typedef typename std::list<std::shared_ptr<TimeSeriesDecodedBlock<BlockSize>>>::iterator NodeIterator;
+    typedef typename std::unordered_map<sequence_s64, NodeIterator>::iterator EntryIterator;
+
+    void removeLocked(EntryIterator found)
+    {
+        if (found->second->use_count() == 1)
+        {
+            m_spare = *found->second;
+        }
+
+        m_lru.erase(found->second);
+        m_entries.erase(found);
+    }
+
+    int m_capacity;
+    size_t m_hitCount;
+    size_t m_missCount;
+    std::shared_ptr<TimeSeriesDecodedBlock<BlockSize>> m_spare;
+    std::list<std::shared_ptr<TimeSeriesDecodedBlock<BlockSize>>> m_lru;
+    std::unordered_map<sequence_s64, NodeIterator> m_entries;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_BLOCK_CACHE_H
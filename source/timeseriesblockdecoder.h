@@ -0,0 +1,141 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef TIME_SERIES_BLOCK_DECODER_H
+#define TIME_SERIES_BLOCK_DECODER_H
+
+#include "timeseriesarraytypes.h"
+#include "timeseriesblockcache.h"
+#include "timeseriesdatablock.h"
+#include "timeseriesdatacontainer.h"
+#include "timeseriestrace.h"
+
+namespace TimeSeries {
+
+template <int BlockSize, bool Compress>
+class TimeSeriesBlockDecoder
+{
+public:
+    TimeSeriesBlockDecoder() :
+        m_count(0),
+        m_times(nullptr),
+        m_timesAlloc(nullptr),
+        m_values(nullptr),
+        m_valuesAlloc(nullptr)
+    {
+    }
+
+    TimeSeriesBlockDecoder(TimeSeriesBlockDecoder&& other) noexcept :
+        m_count(other.m_count),
+        m_times(other.m_times),
+        m_timesAlloc(other.m_timesAlloc),
+        m_values(other.m_values),
+        m_valuesAlloc(other.m_valuesAlloc),
+        m_entry(std::move(other.m_entry))
+    {
+        other.m_count = 0;
+        other.m_times = other.m_timesAlloc = nullptr;
+        other.m_values = other.m_valuesAlloc = nullptr;
+    }
+
+    TimeSeriesBlockDecoder(const TimeSeriesBlockDecoder&) = delete;
+    TimeSeriesBlockDecoder& operator=(const TimeSeriesBlockDecoder&) = delete;
+
+    ~TimeSeriesBlockDecoder()
+    {
+        delete[] m_timesAlloc;
+        delete[] m_valuesAlloc;
+    }
+
+    int decode(const TimeSeriesDataContainer<BlockSize, Compress>* container, int blockIndex)
+    {
+        const auto block = container->block(blockIndex);
+        const auto cache = container->blockCache();
+
+        if (!cache)
+        {
+            return decode(block);
+        }
+
+        return decode(cache, container->blockSequence(blockIndex), block);
+    }
+
+    int decode(const TimeSeriesDataBlock<BlockSize, Compress>* block)
+    {
+        TIME_SERIES_TRACE_SCOPE("block.decode", block->count());
+        if (Compress && !m_timesAlloc)
+        {
+            m_timesAlloc = new time_s64[TimeSeriesDataBlock<BlockSize, Compress>::MaxCount];
+            m_valuesAlloc = new value_u64[TimeSeriesDataBlock<BlockSize, Compress>::MaxCount];
+        }
+
+        m_entry.reset();
+        m_times = m_timesAlloc;
+        m_values = m_valuesAlloc;
+        m_count = block->read(m_times, m_values);
+        return m_count;
+    }
+
+    int count() const
+    {
+        return m_count;
+    }
+
+    const time_s64* times() const
+    {
+        return m_times;
+    }
+
+    const value_double* values() const
+    {
+        return reinterpret_cast<const value_double*>(m_values);
+    }
+
+private:
+    int decode(TimeSeriesBlockCache<BlockSize>* cache, sequence_s64 sequence,
+               const TimeSeriesDataBlock<BlockSize, true>* block)
+    {
+        m_entry = cache->get(sequence, block);
+        m_times = const_cast<time_s64*>(m_entry->times());
+        m_values = const_cast<value_u64*>(m_entry->values());
+        m_count = m_entry->count();
+        return m_count;
+    }
+
+    int decode(TimeSeriesBlockCache<BlockSize>*, sequence_s64,
+               const TimeSeriesDataBlock<BlockSize, false>* block)
+    {
+        return decode(block);
+    }
+
+    int m_count;
+    time_s64* m_times;
+    time_s64* m_timesAlloc;
+    value_u64* m_values;
+    value_u64* m_valuesAlloc;
+    typename TimeSeriesBlockCache<BlockSize>::Entry m_entry;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_BLOCK_DECODER_H
@@ -0,0 +1,190 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef TIME_SERIES_BLOCK_DIRECTORY_H
+#define TIME_SERIES_BLOCK_DIRECTORY_H
+
+#include <cstring>
+
+#include "timeseriesarraytypes.h"
+
+namespace TimeSeries {
+
+struct TimeSeriesBlockInfo
+{
+    time_s64 beginTime;
+    time_s64 endTime;
+    value_u64 beginValue;
+    value_u64 endValue;
+    value_u64 ordinal;
+    value_double minValue;
+    value_double maxValue;
+    value_double sum;
+    int count;
+    int dataSize;
+    int memorySize;
+};
+
+class TimeSeriesBlockDirectory
+{
+public:
+    TimeSeriesBlockDirectory() :
+        m_size(0),
+        m_offset(0),
+        m_allocationSize(256),
+        m_allocationSizeMask(m_allocationSize - 1),
+        m_infoBuffer(new TimeSeriesBlockInfo[m_allocationSize])
+    {
+    }
+
+    TimeSeriesBlockDirectory(const TimeSeriesBlockDirectory&) = delete;
+    TimeSeriesBlockDirectory& operator=(const TimeSeriesBlockDirectory&) = delete;
+
+    ~TimeSeriesBlockDirectory()
+    {
+        delete[] m_infoBuffer;
+    }
+
+    int size() const
+    {
+        return m_size;
+    }
+
+    const TimeSeriesBlockInfo& at(int index) const
+    {
+        return m_infoBuffer[(m_offset + index) & m_allocationSizeMask];
+    }
+
+    TimeSeriesBlockInfo& at(int index)
+    {
+        return m_infoBuffer[(m_offset + index) & m_allocationSizeMask];
+    }
+
+    TimeSeriesBlockInfo& last()
+    {
+        return m_infoBuffer[(m_offset + m_size - 1) & m_allocationSizeMask];
+    }
+
+    const TimeSeriesBlockInfo& last() const
+    {
+        return m_infoBuffer[(m_offset + m_size - 1) & m_allocationSizeMask];
+    }
+
+    void append(const TimeSeriesBlockInfo& info)
+    {
+        if (m_size == m_allocationSize)
+        {
+            grow();
+        }
+
+        m_infoBuffer[(m_offset + m_size) & m_allocationSizeMask] = info;
+        m_size++;
+    }
+
+    void prepend(const TimeSeriesBlockInfo& info)
+    {
+        if (m_size == m_allocationSize)
+        {
+            grow();
+        }
+
+        m_offset = (m_offset - 1) & m_allocationSizeMask;
+        m_infoBuffer[m_offset] = info;
+        m_size++;
+    }
+
+    void removeFirst()
+    {
+        m_offset = (m_offset + 1) & m_allocationSizeMask;
+        m_size--;
+    }
+
+    int findBlock(time_s64 time) const
+    {
+        int low = 0;
+        int high = m_size;
+
+        while (high - low > 1)
+        {
+            const int middle = (low + high) >> 1;
+            if (at(middle).beginTime <= time)
+            {
+                low = middle;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        return low;
+    }
+
+    int findOrdinal(value_u64 ordinal) const
+    {
+        int low = 0;
+        int high = m_size;
+
+        while (high - low > 1)
+        {
+            const int middle = (low + high) >> 1;
+            if (at(middle).ordinal - at(0).ordinal <= ordinal - at(0).ordinal)
+            {
+                low = middle;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        return low;
+    }
+
+private:
+    void grow()
+    {
+        m_allocationSize <<= 1;
+        auto newInfoBuffer = new TimeSeriesBlockInfo[m_allocationSize];
+
+        const int itemCountHead = (m_offset + m_size) & m_allocationSizeMask;
+        const int itemCountTail = m_size - itemCountHead;
+        std::memcpy(newInfoBuffer, m_infoBuffer + m_offset, sizeof(TimeSeriesBlockInfo) * itemCountTail);
+        std::memcpy(newInfoBuffer + itemCountTail, m_infoBuffer, sizeof(TimeSeriesBlockInfo) * itemCountHead);
+
+        delete[] m_infoBuffer;
+        m_infoBuffer = newInfoBuffer;
+        m_allocationSizeMask = m_allocationSize - 1;
+        m_offset = 0;
+    }
+
+    int m_size;
+    int m_offset;
+    int m_allocationSize;
+    int m_allocationSizeMask;
+    TimeSeriesBlockInfo* m_infoBuffer;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_BLOCK_DIRECTORY_H
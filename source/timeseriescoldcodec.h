@@ -0,0 +1,245 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_COLD_CODEC_H
+#define TIME_SERIES_COLD_CODEC_H
+
+#include <cstring>
+
+#include "timeseriesarraytypes.h"
+
+namespace TimeSeries {
+
+class TimeSeriesColdEncoder
+{
+public:
+    TimeSeriesColdEncoder(value_u8* output, int capacity, time_s64 time, value_u64 value) :
+        m_output(output),
+        m_capacity(capacity),
+        m_size(0),
+        m_isOverflow(false),
+        m_buffer(0),
+        m_bufferBits(0),
+        m_time(time),
+        m_timeDiff(0),
+        m_value(value),
+        m_leading(-1),
+        m_trailing(0)
+    {
+    }
+
+    bool append(time_s64 time, value_u64 value)
+    {
+        const time_s64 timeDiff = time - m_time;
+        const time_s64 timeDiffDelta = timeDiff - m_timeDiff;
+        m_time = time;
+        m_timeDiff = timeDiff;
+
+        if (timeDiffDelta == 0)
+        {
+            writeBits(0x00, 1);
+        }
+        else if (timeDiffDelta >= -63 && timeDiffDelta <= 64)
+        {
+            writeBits((0x02 << 7) | static_cast<value_u64>(timeDiffDelta + 63), 9);
+        }
+        else if (timeDiffDelta >= -255 && timeDiffDelta <= 256)
+        {
+            writeBits((0x06 << 9) | static_cast<value_u64>(timeDiffDelta + 255), 12);
+        }
+        else if (timeDiffDelta >= -2047 && timeDiffDelta <= 2048)
+        {
+            writeBits((0x0E << 12) | static_cast<value_u64>(timeDiffDelta + 2047), 16);
+        }
+        else
+        {
+            writeBits(0x0F, 4);
+            writeBits(static_cast<value_u64>(timeDiffDelta), 64);
+        }
+
+        const value_u64 valueDiff = value ^ m_value;
+        m_value = value;
+
+        if (valueDiff == 0)
+        {
+            writeBits(0x00, 1);
+            return !m_isOverflow;
+        }
+
+        const int leading = __builtin_clzll(valueDiff);
+        const int trailing = __builtin_ctzll(valueDiff);
+
+        if (m_leading >= 0 && leading >= m_leading && trailing >= m_trailing)
+        {
+            writeBits(0x02, 2);
+            writeBits(valueDiff >> m_trailing, 64 - m_leading - m_trailing);
+        }
+        else
+        {
+            const int significant = 64 - leading - trailing;
+            writeBits((0x03 << 12) | (leading << 6) | (significant - 1), 14);
+            writeBits(valueDiff >> trailing, significant);
+            m_leading = leading;
+            m_trailing = trailing;
+        }
+
+        return !m_isOverflow;
+    }
+
+    int finish()
+    {
+        for (int shift = 56; m_bufferBits > 0; shift -= 8, m_bufferBits -= 8)
+        {
+            if (m_size >= m_capacity)
+            {
+                m_isOverflow = true;
+                break;
+            }
+            m_output[m_size++] = static_cast<value_u8>(m_buffer >> shift);
+        }
+
+        return m_isOverflow ? -1 : m_size;
+    }
+
+private:
+    void writeBits(value_u64 bits, int count)
+    {
+        const int space = 64 - m_bufferBits;
+        if (count < space)
+        {
+            m_buffer |= bits << (space - count);
+            m_bufferBits += count;
+            return;
+        }
+
+        m_buffer |= bits >> (count - space);
+        if (m_size + 8 <= m_capacity)
+        {
+            const value_u64 word = __builtin_bswap64(m_buffer);
+            std::memcpy(m_output + m_size, &word, sizeof(word));
+            m_size += 8;
+        }
+        else
+        {
+            m_isOverflow = true;
+        }
+
+        m_bufferBits = count - space;
+        m_buffer = m_bufferBits > 0 ? bits << (64 - m_bufferBits) : 0;
+    }
+
+    value_u8* m_output;
+    int m_capacity;
+    int m_size;
+    bool m_isOverflow;
+    value_u64 m_buffer;
+    int m_bufferBits;
+    time_s64 m_time;
+    time_s64 m_timeDiff;
+    value_u64 m_value;
+    int m_leading;
+    int m_trailing;
+};
+
+class TimeSeriesColdDecoder
+{
+public:
+    TimeSeriesColdDecoder(const value_u8* input, time_s64 time, value_u64 value) :
+        m_input(input),
+        m_bitOffset(0),
+        m_time(time),
+        m_timeDiff(0),
+        m_value(value),
+        m_leading(0),
+        m_trailing(0)
+    {
+    }
+
+    void next(time_s64& time, value_u64& value)
+    {
+        time_s64 timeDiffDelta = 0;
+        if (readBits(1))
+        {
+            if (!readBits(1))
+            {
+                timeDiffDelta = static_cast<time_s64>(readBits(7)) - 63;
+            }
+            else if (!readBits(1))
+            {
+                timeDiffDelta = static_cast<time_s64>(readBits(9)) - 255;
+            }
+            else if (!readBits(1))
+            {
+                timeDiffDelta = static_cast<time_s64>(readBits(12)) - 2047;
+            }
+            else
+            {
+                timeDiffDelta = static_cast<time_s64>(readBits(64));
+            }
+        }
+
+        m_timeDiff += timeDiffDelta;
+        m_time += m_timeDiff;
+
+        if (readBits(1))
+        {
+            if (readBits(1))
+            {
+                const value_u64 window = readBits(12);
+                m_leading = static_cast<int>(window >> 6);
+                m_trailing = 64 - m_leading - static_cast<int>((window & 0x3F) + 1);
+            }
+            m_value ^= readBits(64 - m_leading - m_trailing) << m_trailing;
+        }
+
+        time = m_time;
+        value = m_value;
+    }
+
+private:
+    value_u64 readBits(int count)
+    {
+        if (count > 56)
+        {
+            const value_u64 high = readBits(count - 32);
+            return (high << 32) | readBits(32);
+        }
+
+        value_u64 word;
+        std::memcpy(&word, m_input + (m_bitOffset >> 3), sizeof(word));
+        word = __builtin_bswap64(word) << (m_bitOffset & 0x07);
+        m_bitOffset += count;
+        return word >> (64 - count);
+    }
+
+    const value_u8* m_input;
+    int m_bitOffset;
+    time_s64 m_time;
+    time_s64 m_timeDiff;
+    value_u64 m_value;
+    int m_leading;
+    int m_trailing;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_COLD_CODEC_H
@@ -0,0 +1,97 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_COLD_COMPACTOR_H
+#define TIME_SERIES_COLD_COMPACTOR_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "timeseriesarraytypes.h"
+#include "timeseriesdatacontainer.h"
+
+namespace TimeSeries {
+
+template <int BlockSize, bool Compress>
+class TimeSeriesColdCompactor
+{
+public:
+    TimeSeriesColdCompactor(TimeSeriesDataContainer<BlockSize, Compress>* container, time_s64 age,
+                            int intervalMillis) :
+        m_age(age),
+        m_intervalMillis(intervalMillis > 0 ? intervalMillis : 1),
+        m_isRunning(true),
+        m_container(container)
+    {
+        m_thread = std::thread(&TimeSeriesColdCompactor::run, this);
+    }
+
+    TimeSeriesColdCompactor(const TimeSeriesColdCompactor&) = delete;
+    TimeSeriesColdCompactor& operator=(const TimeSeriesColdCompactor&) = delete;
+
+    ~TimeSeriesColdCompactor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_isRunning = false;
+        }
+        m_condition.notify_one();
+        m_thread.join();
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (m_isRunning)
+        {
+            lock.unlock();
+            while (m_container->compactColdBlock(m_age) && isRunning())
+            {
+            }
+            lock.lock();
+
+            m_condition.wait_for(lock, std::chrono::milliseconds(m_intervalMillis), [this] { return !m_isRunning; });
+        }
+    }
+
+    bool isRunning()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_isRunning;
+    }
+
+    time_s64 m_age;
+    int m_intervalMillis;
+    bool m_isRunning;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::thread m_thread;
+    TimeSeriesDataContainer<BlockSize, Compress>* m_container;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_COLD_COMPACTOR_H
@@ -0,0 +1,401 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_CROSS_QUERY_H
+#define TIME_SERIES_CROSS_QUERY_H
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "timeseriesaggregate.h"
+#include "timeseriesarray.h"
+#include "timeseriesarraytypes.h"
+#include "timeseriessnapshot.h"
+
+namespace TimeSeries {
+
+enum class TimeSeriesRankBy
+{
+    Max,
+    Min,
+    Sum,
+    Mean,
+    Count
+};
+
+struct TimeSeriesRankedSeries
+{
+    size_t series;
+    value_double value;
+};
+
+struct TimeSeriesCrossQueryStats
+{
+    TimeSeriesCrossQueryStats() :
+        seriesCount(0),
+        prunedSeriesCount(0),
+        summaryBlockCount(0),
+        decodedBlockCount(0)
+    {
+    }
+
+    size_t seriesCount;
+    size_t prunedSeriesCount;
+    size_t summaryBlockCount;
+    size_t decodedBlockCount;
+};
+
+template <int BlockSize, bool Compress>
+class TimeSeriesCrossQuery
+{
+public:
+    typedef TimeSeriesArray<BlockSize, Compress> Array;
+    typedef TimeSeriesSnapshot<BlockSize, Compress> Snapshot;
+
+    TimeSeriesCrossQuery(int threadCount = 0) :
+        m_threadCount(threadCount > 0 ? threadCount
+                                      : std::max(1, static_cast<int>(std::thread::hardware_concurrency())))
+    {
+    }
+
+    void addSeries(Array* array, const std::string& tag = std::string())
+    {
+        m_series.push_back(array);
+        m_tags.push_back(tag);
+    }
+
+    size_t seriesCount() const
+    {
+        return m_series.size();
+    }
+
+    const std::string& tag(size_t series) const
+    {
+        return m_tags[series];
+    }
+
+    const TimeSeriesCrossQueryStats& stats() const
+    {
+        return m_stats;
+    }
+
+    std::vector<TimeSeriesRankedSeries> topK(size_t k, TimeSeriesRankBy rankBy,
+                                             time_s64 beginTime, time_s64 endTime = -1)
+    {
+        if (endTime < 0)
+        {
+            endTime = std::numeric_limits<time_s64>::max();
+        }
+
+        const bool isExtremum = rankBy == TimeSeriesRankBy::Max || rankBy == TimeSeriesRankBy::Min;
+        const value_double sign = rankBy == TimeSeriesRankBy::Min ? -1.0 : 1.0;
+        std::vector<Partial> partials(m_series.size());
+        Counters counters;
+
+        parallelFor(m_series.size(), [&](size_t series) {
+            collect(series, beginTime, endTime, isExtremum, sign, partials[series], counters);
+        });
+
+        std::vector<value_double> lowerBounds;
+        for (const Partial& partial : partials)
+        {
+            if (partial.aggregate.count > 0)
+            {
+                lowerBounds.push_back(rankValue(partial.aggregate, rankBy) * sign);
+            }
+        }
+
+        value_double threshold = -std::numeric_limits<value_double>::infinity();
+        if (isExtremum && k > 0 && lowerBounds.size() >= k)
+        {
+            std::nth_element(lowerBounds.begin(), lowerBounds.begin() + (k - 1), lowerBounds.end(),
+                             [](value_double left, value_double right) { return left > right; });
+            threshold = lowerBounds[k - 1];
+        }
+
+        std::vector<size_t> order;
+        for (size_t series = 0; series < partials.size(); ++series)
+        {
+            if (!partials[series].pendingBlocks.empty())
+            {
+                order.push_back(series);
+            }
+        }
+        std::sort(order.begin(), order.end(), [&](size_t left, size_t right) {
+            return partials[left].bound > partials[right].bound;
+        });
+
+        parallelFor(order.size(), [&](size_t index) {
+            Partial& partial = partials[order[index]];
+            if (partial.bound < threshold)
+            {
+                counters.prunedSeriesCount++;
+            }
+            else
+            {
+                resolve(beginTime, endTime, sign, partial, counters);
+            }
+            partial.snapshot.reset();
+        });
+
+        std::vector<TimeSeriesRankedSeries> ranked;
+        for (size_t series = 0; series < partials.size(); ++series)
+        {
+            if (partials[series].aggregate.count > 0)
+            {
+                ranked.push_back(TimeSeriesRankedSeries{series, rankValue(partials[series].aggregate, rankBy)});
+            }
+        }
+
+        const size_t rankedCount = std::min(k, ranked.size());
+        std::partial_sort(ranked.begin(), ranked.begin() + rankedCount, ranked.end(),
+                          [&](const TimeSeriesRankedSeries& left, const TimeSeriesRankedSeries& right) {
+                              return left.value * sign > right.value * sign;
+                          });
+        ranked.resize(rankedCount);
+
+        counters.store(m_stats, m_series.size());
+        return ranked;
+    }
+
+    std::map<std::string, TimeSeriesAggregate> groupBy(time_s64 beginTime, time_s64 endTime = -1)
+    {
+        const std::vector<TimeSeriesAggregate> aggregates = aggregateSeries(beginTime, endTime);
+
+        std::map<std::string, TimeSeriesAggregate> groups;
+        for (size_t series = 0; series < aggregates.size(); ++series)
+        {
+            groups[m_tags[series]].merge(aggregates[series]);
+        }
+        return groups;
+    }
+
+    TimeSeriesAggregate sum(time_s64 beginTime, time_s64 endTime = -1)
+    {
+        const std::vector<TimeSeriesAggregate> aggregates = aggregateSeries(beginTime, endTime);
+
+        TimeSeriesAggregate total;
+        for (const TimeSeriesAggregate& aggregate : aggregates)
+        {
+            total.merge(aggregate);
+        }
+        return total;
+    }
+
+private:
+    struct Partial
+    {
+        Partial() :
+            bound(-std::numeric_limits<value_double>::infinity())
+        {
+        }
+
+        TimeSeriesAggregate aggregate;
+        value_double bound;
+        std::vector<int> pendingBlocks;
+        std::unique_ptr<Snapshot> snapshot;
+    };
+
+    struct Counters
+    {
+        Counters() :
+            prunedSeriesCount(0),
+            summaryBlockCount(0),
+            decodedBlockCount(0)
+        {
+        }
+
+        void store(TimeSeriesCrossQueryStats& stats, size_t seriesCount) const
+        {
+            stats.seriesCount = seriesCount;
+            stats.prunedSeriesCount = prunedSeriesCount;
+            stats.summaryBlockCount = summaryBlockCount;
+            stats.decodedBlockCount = decodedBlockCount;
+        }
+
+        std::atomic<size_t> prunedSeriesCount;
+        std::atomic<size_t> summaryBlockCount;
+        std::atomic<size_t> decodedBlockCount;
+    };
+
+    std::vector<TimeSeriesAggregate> aggregateSeries(time_s64 beginTime, time_s64 endTime)
+    {
+        if (endTime < 0)
+        {
+            endTime = std::numeric_limits<time_s64>::max();
+        }
+
+        std::vector<Partial> partials(m_series.size());
+        Counters counters;
+
+        parallelFor(m_series.size(), [&](size_t series) {
+            collect(series, beginTime, endTime, false, 1.0, partials[series], counters);
+        });
+
+        std::vector<TimeSeriesAggregate> aggregates;
+        for (const Partial& partial : partials)
+        {
+            aggregates.push_back(partial.aggregate);
+        }
+
+        counters.store(m_stats, m_series.size());
+        return aggregates;
+    }
+
+    void collect(size_t series, time_s64 beginTime, time_s64 endTime, bool deferEdges, value_double sign,
+                 Partial& partial, Counters& counters) const
+    {
+        std::unique_ptr<Snapshot> snapshot(new Snapshot(m_series[series]->snapshot()));
+        const int blockCount = snapshot->blockCount();
+
+        int low = 0;
+        int high = blockCount;
+        while (low < high)
+        {
+            const int middle = (low + high) / 2;
+            if (snapshot->isSummarized(middle) && snapshot->blockInfo(middle).endTime < beginTime)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        for (int index = low; index < blockCount && snapshot->blockInfo(index).beginTime <= endTime; ++index)
+        {
+            const TimeSeriesBlockInfo& info = snapshot->blockInfo(index);
+
+            if (snapshot->isSummarized(index) && info.beginTime >= beginTime && info.endTime <= endTime)
+            {
+                TimeSeriesAggregate summary;
+                summary.count = info.count;
+                summary.sum = info.sum;
+                summary.min = info.minValue;
+                summary.max = info.maxValue;
+                partial.aggregate.merge(summary);
+                counters.summaryBlockCount++;
+            }
+            else if (snapshot->isSummarized(index) && deferEdges)
+            {
+                partial.pendingBlocks.push_back(index);
+                partial.bound = std::max(partial.bound, blockBound(info, sign));
+            }
+            else
+            {
+                snapshot->aggregateBlock(index, beginTime, endTime, partial.aggregate);
+                counters.decodedBlockCount++;
+            }
+        }
+
+        if (partial.aggregate.count > 0)
+        {
+            partial.bound = std::max(partial.bound, extremum(partial.aggregate, sign));
+        }
+        if (!partial.pendingBlocks.empty())
+        {
+            partial.snapshot = std::move(snapshot);
+        }
+    }
+
+    static void resolve(time_s64 beginTime, time_s64 endTime, value_double sign,
+                        Partial& partial, Counters& counters)
+    {
+        for (const int index : partial.pendingBlocks)
+        {
+            if (partial.aggregate.count > 0 &&
+                blockBound(partial.snapshot->blockInfo(index), sign) <= extremum(partial.aggregate, sign))
+            {
+                continue;
+            }
+
+            partial.snapshot->aggregateBlock(index, beginTime, endTime, partial.aggregate);
+            counters.decodedBlockCount++;
+        }
+    }
+
+    static value_double blockBound(const TimeSeriesBlockInfo& info, value_double sign)
+    {
+        return sign > 0.0 ? info.maxValue : -info.minValue;
+    }
+
+    static value_double extremum(const TimeSeriesAggregate& aggregate, value_double sign)
+    {
+        return sign > 0.0 ? aggregate.max : -aggregate.min;
+    }
+
+    static value_double rankValue(const TimeSeriesAggregate& aggregate, TimeSeriesRankBy rankBy)
+    {
+        switch (rankBy)
+        {
+        case TimeSeriesRankBy::Max:
+            return aggregate.max;
+        case TimeSeriesRankBy::Min:
+            return aggregate.min;
+        case TimeSeriesRankBy::Sum:
+            return aggregate.sum;
+        case TimeSeriesRankBy::Mean:
+            return aggregate.mean();
+        case TimeSeriesRankBy::Count:
+            return static_cast<value_double>(aggregate.count);
+        }
+        return 0.0;
+    }
+
+    template <class Function>
+    void parallelFor(size_t count, Function&& function) const
+    {
+        std::atomic<size_t> next(0);
+        std::vector<std::thread> threads;
+
+        const size_t threadCount = std::min(static_cast<size_t>(m_threadCount), count);
+        for (size_t thread = 0; thread < threadCount; ++thread)
+        {
+            threads.emplace_back([&]() {
+                for (size_t index = next++; index < count; index = next++)
+                {
+                    function(index);
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    int m_threadCount;
+    std::vector<Array*> m_series;
+    std::vector<std::string> m_tags;
+    TimeSeriesCrossQueryStats m_stats;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_CROSS_QUERY_H
@@ -0,0 +1,333 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_CURSOR_H
+#define TIME_SERIES_CURSOR_H
+
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <string>
+
+#include "timeseriesarraytypes.h"
+#include "timeseriesdatablock.h"
+#include "timeseriesdatacontainer.h"
+
+namespace TimeSeries {
+
+struct TimeSeriesCursor
+{
+    TimeSeriesCursor() :
+        sequence(0),
+        blockBeginTime(std::numeric_limits<time_s64>::min()),
+        lastTime(std::numeric_limits<time_s64>::min()),
+        beginTime(0),
+        endTime(-1),
+        isAtEnd(false),
+        isExpired(false)
+    {
+    }
+
+    std::string toToken() const
+    {
+        value_u8 data[TokenSize];
+        value_u8* output = data;
+
+        output[0] = TokenVersion;
+        output = write(output + 1, static_cast<value_u64>(sequence));
+        output = write(output, static_cast<value_u64>(state.byteOffset));
+        output = write(output, static_cast<value_u64>(state.sampleIndex));
+        output = write(output, static_cast<value_u64>(state.recordIndex));
+        output = write(output, static_cast<value_u64>(state.time));
+        output = write(output, state.value);
+        output = write(output, static_cast<value_u64>(blockBeginTime));
+        output = write(output, static_cast<value_u64>(lastTime));
+        output = write(output, static_cast<value_u64>(beginTime));
+        output = write(output, static_cast<value_u64>(endTime));
+        output = write(output, checksum(data, static_cast<int>(output - data)));
+
+        static const char digits[] = "0123456789abcdef";
+        std::string token(TokenSize * 2, '0');
+        for (int index = 0; index < TokenSize; ++index)
+        {
+            token[index * 2] = digits[data[index] >> 4];
+            token[index * 2 + 1] = digits[data[index] & 0x0F];
+        }
+        return token;
+    }
+
+    static bool fromToken(const std::string& token, TimeSeriesCursor& cursor)
+    {
+        if (token.size() != TokenSize * 2)
+        {
+            return false;
+        }
+
+        value_u8 data[TokenSize];
+        for (int index = 0; index < TokenSize; ++index)
+        {
+            const int high = digit(token[index * 2]);
+            const int low = digit(token[index * 2 + 1]);
+            if (high < 0 || low < 0)
+            {
+                return false;
+            }
+            data[index] = static_cast<value_u8>((high << 4) | low);
+        }
+
+        const value_u8* input = data + 1;
+        const value_u64 sequence = read(input);
+        const value_u64 byteOffset = read(input);
+        const value_u64 sampleIndex = read(input);
+        const value_u64 recordIndex = read(input);
+        const value_u64 time = read(input);
+        const value_u64 value = read(input);
+        const value_u64 blockBeginTime = read(input);
+        const value_u64 lastTime = read(input);
+        const value_u64 beginTime = read(input);
+        const value_u64 endTime = read(input);
+        const int checksumOffset = static_cast<int>(input - data);
+
+        if (data[0] != TokenVersion || read(input) != checksum(data, checksumOffset) ||
+            byteOffset > static_cast<value_u64>(BlockSizeLimit) ||
+            sampleIndex > static_cast<value_u64>(BlockSizeLimit) ||
+            recordIndex > static_cast<value_u64>(BlockSizeLimit))
+        {
+            return false;
+        }
+
+        cursor = TimeSeriesCursor();
+        cursor.sequence = static_cast<sequence_s64>(sequence);
+        cursor.state.byteOffset = static_cast<int>(byteOffset);
+        cursor.state.sampleIndex = static_cast<int>(sampleIndex);
+        cursor.state.recordIndex = static_cast<int>(recordIndex);
+        cursor.state.time = static_cast<time_s64>(time);
+        cursor.state.value = value;
+        cursor.blockBeginTime = static_cast<time_s64>(blockBeginTime);
+        cursor.lastTime = static_cast<time_s64>(lastTime);
+        cursor.beginTime = static_cast<time_s64>(beginTime);
+        cursor.endTime = static_cast<time_s64>(endTime);
+        return true;
+    }
+
+    sequence_s64 sequence;
+    TimeSeriesBlockReadState state;
+    time_s64 blockBeginTime;
+    time_s64 lastTime;
+    time_s64 beginTime;
+    time_s64 endTime;
+    bool isAtEnd;
+    bool isExpired;
+
+private:
+    static const int TokenVersion = 1;
+    static const int TokenSize = 1 + 10 * 8 + 8;
+    static const int BlockSizeLimit = 1 << 30;
+
+    static value_u8* write(value_u8* output, value_u64 value)
+    {
+        for (int index = 0; index < 8; ++index)
+        {
+            output[index] = static_cast<value_u8>(value >> (index * 8));
+        }
+        return output + 8;
+    }
+
+    static value_u64 read(const value_u8*& input)
+    {
+        value_u64 value = 0;
+        for (int index = 0; index < 8; ++index)
+        {
+            value |= static_cast<value_u64>(input[index]) << (index * 8);
+        }
+        input += 8;
+        return value;
+    }
+
+    static value_u64 checksum(const value_u8* data, int size)
+    {
+        value_u64 hash = 0xCBF29CE484222325ULL;
+        for (int index = 0; index < size; ++index)
+        {
+            hash = (hash ^ data[index]) * 0x100000001B3ULL;
+        }
+        return hash;
+    }
+
+    static int digit(char character)
+    {
+        if (character >= '0' && character <= '9')
+        {
+            return character - '0';
+        }
+        if (character >= 'a' && character <= 'f')
+        {
+            return character - 'a' + 10;
+        }
+        return -1;
+    }
+};
+
+template <int BlockSize, bool Compress>
+class TimeSeriesCursorReader
+{
+public:
+    typedef TimeSeriesDataBlock<BlockSize, Compress> Block;
+
+    TimeSeriesCursorReader(TimeSeriesDataContainer<BlockSize, Compress>* container) :
+        m_container(container)
+    {
+    }
+
+    TimeSeriesCursor seek(time_s64 beginTime, time_s64 endTime) const
+    {
+        std::lock_guard<std::mutex> lock(m_container->structureMutex());
+
+        TimeSeriesCursor cursor;
+        cursor.beginTime = beginTime;
+        cursor.endTime = endTime;
+        cursor.sequence = m_container->blockSequence(m_container->blockCount() > 0 ? m_container->findBlock(beginTime)
+                                                                                   : 0);
+        return cursor;
+    }
+
+    int read(TimeSeriesCursor& cursor, time_s64* times, value_double* values, int capacity)
+    {
+        int readCount = 0;
+        if (cursor.isExpired || (cursor.endTime >= 0 && cursor.lastTime >= cursor.endTime))
+        {
+            cursor.isAtEnd = !cursor.isExpired;
+            return readCount;
+        }
+
+        const sequence_s64 pinnedSequence = cursor.sequence;
+        {
+            std::lock_guard<std::mutex> lock(m_container->structureMutex());
+
+            const sequence_s64 index = cursor.sequence - m_container->blockSequence(0);
+            if (index < 0 || index > m_container->blockCount() ||
+                (cursor.state.sampleIndex > 0 && (index == m_container->blockCount() ||
+                 m_container->block(static_cast<int>(index))->beginTime() != cursor.blockBeginTime)))
+            {
+                cursor.isExpired = true;
+                return readCount;
+            }
+            m_container->pinBlocks(pinnedSequence);
+        }
+
+        cursor.isAtEnd = false;
+        value_u64* rawValues = reinterpret_cast<value_u64*>(values);
+
+        while (readCount < capacity)
+        {
+            const Block* block = nullptr;
+            bool hasNextBlock = false;
+            {
+                std::lock_guard<std::mutex> lock(m_container->structureMutex());
+
+                const sequence_s64 index = cursor.sequence - m_container->blockSequence(0);
+                if (index < 0)
+                {
+                    cursor.isExpired = true;
+                    break;
+                }
+                if (index >= m_container->blockCount())
+                {
+                    cursor.isAtEnd = true;
+                    break;
+                }
+                block = m_container->block(static_cast<int>(index));
+                hasNextBlock = index + 1 < m_container->blockCount();
+            }
+
+            if (cursor.state.sampleIndex == 0)
+            {
+                cursor.blockBeginTime = block->beginTime();
+            }
+
+            const int requestCount = capacity - readCount;
+            const int count = block->readCommitted(cursor.state, times + readCount, rawValues + readCount,
+                                                   requestCount);
+            readCount += clip(cursor, times + readCount, values + readCount, count);
+
+            if (cursor.isAtEnd)
+            {
+                break;
+            }
+            if (count == requestCount)
+            {
+                continue;
+            }
+            if (!hasNextBlock)
+            {
+                cursor.isAtEnd = true;
+                break;
+            }
+
+            cursor.sequence++;
+            cursor.state = TimeSeriesBlockReadState();
+        }
+
+        m_container->unpinBlocks(pinnedSequence);
+        return readCount;
+    }
+
+private:
+    static int clip(TimeSeriesCursor& cursor, time_s64* times, value_double* values, int count)
+    {
+        if (count == 0)
+        {
+            return count;
+        }
+
+        cursor.lastTime = times[count - 1];
+
+        int beginIndex = 0;
+        while (beginIndex < count && times[beginIndex] < cursor.beginTime)
+        {
+            ++beginIndex;
+        }
+
+        int endIndex = count;
+        if (cursor.endTime >= 0)
+        {
+            while (endIndex > beginIndex && times[endIndex - 1] > cursor.endTime)
+            {
+                --endIndex;
+            }
+            cursor.isAtEnd = cursor.lastTime >= cursor.endTime;
+        }
+
+        if (beginIndex > 0)
+        {
+            std::memmove(times, times + beginIndex, (endIndex - beginIndex) * sizeof(time_s64));
+            std::memmove(values, values + beginIndex, (endIndex - beginIndex) * sizeof(value_double));
+        }
+        return endIndex - beginIndex;
+    }
+
+    TimeSeriesDataContainer<BlockSize, Compress>* m_container;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_CURSOR_H
@@ -23,10 +23,35 @@
 #ifndef TIME_SERIES_DATA_BLOCK_H
 #define TIME_SERIES_DATA_BLOCK_H
 
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include "timeseriesaggregate.h"
 #include "timeseriesarraytypes.h"
+#include "timeseriesblockimage.h"
+#include "timeseriescoldcodec.h"
 
 namespace TimeSeries {
 
+struct TimeSeriesBlockReadState
+{
+    TimeSeriesBlockReadState() :
+        byteOffset(0),
+        sampleIndex(0),
+        recordIndex(0),
+        time(0),
+        value(0)
+    {
+    }
+
+    int byteOffset;
+    int sampleIndex;
+    int recordIndex;
+    time_s64 time;
+    value_u64 value;
+};
+
 template <int BlockSize, bool Compressed>
 class TimeSeriesDataBlock;
 
@@ -34,16 +59,33 @@ template <int BlockSize>
 class TimeSeriesDataBlock<BlockSize, true>
 {
 public:
+    static const int MaxCount = BlockSize / 2 + 1;
+    static const int PayloadSize = BlockSize;
+
     TimeSeriesDataBlock(time_s64 time, value_u64 value) :
+        m_count(1),
         m_dataSize(0),
+        m_capacity(BlockSize),
+        m_runOffset(-1),
+        m_runTimeDiff(0),
         m_beginTime(time),
         m_endTime(time),
         m_beginValue(value),
-        m_endValue(value)
+        m_endValue(value),
+        m_isCold(false),
+        m_isSealed(false),
+        m_committed(1),
+        m_data(new value_u8[BlockSize])
     {
     }
 
-    ~TimeSeriesDataBlock() = default;
+    TimeSeriesDataBlock(const TimeSeriesDataBlock&) = delete;
+    TimeSeriesDataBlock& operator=(const TimeSeriesDataBlock&) = delete;
+
+    ~TimeSeriesDataBlock()
+    {
+        delete[] m_data;
+    }
 
     time_s64 beginTime() const
     {
@@ -65,6 +107,11 @@ public:
         return m_endValue;
     }
 
+    int count() const
+    {
+        return m_count;
+    }
+
     int size() const
     {
         return m_dataSize;
@@ -75,6 +122,94 @@ public:
         return 16 + m_dataSize;
     }
 
+    void prefetch() const
+    {
+        for (int offset = 0; offset < m_dataSize; offset += 64)
+        {
+            __builtin_prefetch(m_data + offset);
+        }
+    }
+
+    size_t memorySize() const
+    {
+        return sizeof(*this) + m_capacity;
+    }
+
+    bool isSealed() const
+    {
+        return m_isSealed;
+    }
+
+    bool isCold() const
+    {
+        return m_isCold;
+    }
+
+    const value_u8* data() const
+    {
+        return m_data;
+    }
+
+    static TimeSeriesDataBlock* recompress(const TimeSeriesDataBlock* block)
+    {
+        if (block->m_isCold || block->m_count < 2)
+        {
+            return nullptr;
+        }
+
+        std::vector<time_s64> times(MaxCount);
+        std::vector<value_u64> values(MaxCount);
+        const int count = block->read(times.data(), values.data());
+
+        std::vector<value_u8> data(block->m_dataSize + 8);
+        TimeSeriesColdEncoder encoder(data.data(), block->m_dataSize, times[0], values[0]);
+        for (int index = 1; index < count; ++index)
+        {
+            if (!encoder.append(times[index], values[index]))
+            {
+                return nullptr;
+            }
+        }
+
+        const int dataSize = encoder.finish();
+        if (dataSize < 0)
+        {
+            return nullptr;
+        }
+
+        TimeSeriesDataBlock* coldBlock = new TimeSeriesDataBlock(block->m_beginTime, block->m_beginValue);
+        delete[] coldBlock->m_data;
+        coldBlock->m_data = new value_u8[dataSize + 8]();
+        std::memcpy(coldBlock->m_data, data.data(), dataSize);
+        coldBlock->m_capacity = dataSize + 8;
+        coldBlock->m_dataSize = dataSize;
+        coldBlock->m_count = count;
+        coldBlock->m_endTime = block->m_endTime;
+        coldBlock->m_endValue = block->m_endValue;
+        coldBlock->m_isCold = true;
+        coldBlock->m_isSealed = true;
+        coldBlock->commit();
+        return coldBlock;
+    }
+
+    void seal()
+    {
+        m_isSealed = true;
+
+        const int capacity = m_dataSize + 8 < BlockSize ? m_dataSize + 8 : BlockSize;
+        if (capacity >= m_capacity)
+        {
+            return;
+        }
+
+        value_u8* data = new value_u8[capacity];
+        std::memcpy(data, m_data, capacity);
+        delete[] m_data;
+
+        m_data = data;
+        m_capacity = capacity;
+    }
+
     bool append(time_s64 time, value_u64 value)
     {
         if (time <= m_endTime)
@@ -82,44 +217,202 @@ public:
             return true;
         }
 
-        const time_u32 timeDiff = static_cast<time_u32>(time - m_endTime);
-        const int timeDiffSize = 0x03 ^ (countLeadingZeroBits(timeDiff) >> 3);
+        if (m_count >= MaxCount || m_isSealed)
+        {
+            return false;
+        }
+
+        const value_u64 timeDiff = static_cast<value_u64>(time - m_endTime);
+
+        if (value == m_endValue && timeDiff == m_runTimeDiff && m_runOffset >= 0 && appendRun())
+        {
+            m_endTime = time;
+            m_count++;
+            commit();
+            return true;
+        }
+
+        const int timeDiffUsedBytes = 8 - (countLeadingZeroBits(timeDiff) >> 3);
+        const int isWide = timeDiffUsedBytes > 4;
+        const int timeDiffSize = isWide ? 0x03 : timeDiffUsedBytes - 1;
+        const int timeDiffBytes = (timeDiffSize + 1) << isWide;
 
         value_u64 valueOut = value ^ m_endValue;
         const int valueOutSizeTrailing = countTrailingZeroBits(valueOut) >> 3;
         valueOut >>= valueOutSizeTrailing << 3;
 
         const int valueOutSize = 8 - valueOutSizeTrailing;
-        const int needsBytes = timeDiffSize + valueOutSize + 2;
+        const int needsBytes = timeDiffBytes + valueOutSize + 1;
 
-        if (m_dataSize + needsBytes + (8 - valueOutSize) > BlockSize)
+        if (m_dataSize + needsBytes + (8 - valueOutSize) > m_capacity)
         {
             return false;
         }
 
         value_u8* output = m_data + m_dataSize;
-        output[0] = (timeDiffSize << 6) | valueOutSize;
+        output[0] = (timeDiffSize << 6) | (isWide ? WideFlag : 0) | valueOutSize;
+
+        *reinterpret_cast<value_u64*>(output + 1) = timeDiff;
+        *reinterpret_cast<value_u64*>(output + timeDiffBytes + 1) = valueOut;
 
-        *reinterpret_cast<time_u32*>(output + 1) = timeDiff;
-        *reinterpret_cast<value_u64*>(output + timeDiffSize + 2) = valueOut;
+        m_runOffset = valueOutSize == 0 ? m_dataSize : -1;
+        m_runTimeDiff = timeDiff;
 
         m_endTime = time;
         m_endValue = value;
         m_dataSize += needsBytes;
+        m_count++;
+        commit();
+
+        return true;
+    }
+
+    void exportImage(TimeSeriesBlockImage& image, value_u8* payload, int fromSize) const
+    {
+        if (m_isCold)
+        {
+            std::vector<time_s64> times(MaxCount);
+            std::vector<value_u64> values(MaxCount);
+            const int count = read(times.data(), values.data());
+
+            TimeSeriesDataBlock block(m_beginTime, m_beginValue);
+            for (int index = 1; index < count; ++index)
+            {
+                block.append(times[index], values[index]);
+            }
+            block.exportImage(image, payload, fromSize);
+            return;
+        }
+
+        image.beginTime = m_beginTime;
+        image.endTime = m_endTime;
+        image.beginValue = m_beginValue;
+        image.endValue = m_endValue;
+        image.count = m_count;
+        image.size = m_dataSize;
+
+        const int offset = fromSize > 16 ? fromSize - 16 : 0;
+        std::memcpy(payload + offset, m_data + offset, m_dataSize - offset);
+    }
+
+    bool importImage(const TimeSeriesBlockImage& image, const value_u8* payload, int fromSize)
+    {
+        if (image.size < fromSize || image.size > m_capacity || image.count < 1 || image.count > MaxCount)
+        {
+            return false;
+        }
 
+        const int offset = fromSize > 16 ? fromSize - 16 : 0;
+        std::memcpy(m_data + offset, payload + offset, image.size - offset);
+
+        m_beginTime = image.beginTime;
+        m_endTime = image.endTime;
+        m_beginValue = image.beginValue;
+        m_endValue = image.endValue;
+        m_count = image.count;
+        m_dataSize = image.size;
+        m_runOffset = -1;
+        m_isCold = false;
+        commit();
         return true;
     }
 
-    int readAtOffset(int byteOffset, time_s64& time, value_u64& value) const
+    value_u64 committedExtent() const
+    {
+        return m_committed.load(std::memory_order_acquire);
+    }
+
+    int readCommitted(TimeSeriesBlockReadState& state, time_s64* times, value_u64* values, int capacity) const
+    {
+        return readExtent(state, committedExtent(), times, values, capacity);
+    }
+
+    int readExtent(TimeSeriesBlockReadState& state, value_u64 extent,
+                   time_s64* times, value_u64* values, int capacity) const
+    {
+        const int dataSize = static_cast<int>(extent >> 32);
+        const int count = static_cast<int>(extent & 0xFFFFFFFF);
+        int outCount = 0;
+
+        if (m_isCold)
+        {
+            return readColdExtent(state, count, times, values, capacity);
+        }
+
+        if (state.sampleIndex == 0 && capacity > 0)
+        {
+            state.time = times[outCount] = m_beginTime;
+            state.value = values[outCount++] = m_beginValue;
+            state.sampleIndex = 1;
+        }
+
+        while (state.sampleIndex < count && outCount < capacity && state.byteOffset < dataSize)
+        {
+            const value_u8* input = m_data + state.byteOffset;
+            const value_u8 infoByte = *reinterpret_cast<const volatile value_u8*>(input);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const int timeDiffSize = timeDiffBytes(infoByte);
+            const int valueDiffSize = infoByte & 0x0F;
+            const time_s64 timeDiff = *reinterpret_cast<const value_u64*>(input + 1) & timeDiffMask(timeDiffSize);
+
+            int recordEnd = state.byteOffset + 1 + timeDiffSize;
+            int runCount = 1;
+            value_u64 value = state.value;
+
+            if (infoByte & RunFlag)
+            {
+                runCount = *reinterpret_cast<const volatile value_u16*>(input + 1 + timeDiffSize);
+                recordEnd += 2;
+            }
+            else if (valueDiffSize)
+            {
+                value ^= *reinterpret_cast<const value_u64*>(input + 1 + timeDiffSize) << ((8 - valueDiffSize) << 3);
+                recordEnd += valueDiffSize;
+            }
+
+            while (state.recordIndex < runCount && state.sampleIndex < count && outCount < capacity)
+            {
+                ++state.recordIndex;
+                ++state.sampleIndex;
+                times[outCount] = state.time + state.recordIndex * timeDiff;
+                values[outCount++] = value;
+            }
+
+            if (state.recordIndex < runCount || recordEnd >= dataSize)
+            {
+                break;
+            }
+
+            state.time += runCount * timeDiff;
+            state.value = value;
+            state.byteOffset = recordEnd;
+            state.recordIndex = 0;
+        }
+
+        return outCount;
+    }
+
+    int readAtOffset(int byteOffset, int& runIndex, time_s64& time, value_u64& value) const
     {
         const value_u8 *input = m_data + byteOffset;
         const value_u8 infoByte = input[0];
-        const int timeDiffSize = (infoByte >> 6) & 0x03;
-        const int valueDiffIndex = timeDiffSize + 2;
+        const int timeDiffSize = timeDiffBytes(infoByte);
+        const int valueDiffIndex = timeDiffSize + 1;
         const int valueDiffSize = infoByte & 0x0F;
 
         value_u64 dataValue = *reinterpret_cast<const value_u64*>(input + 1);
-        time += dataValue & ((1ULL << ((timeDiffSize + 1) << 3)) - 1);
+        time += dataValue & timeDiffMask(timeDiffSize);
+
+        if (infoByte & RunFlag)
+        {
+            if (++runIndex < *reinterpret_cast<const value_u16*>(input + valueDiffIndex))
+            {
+                return 0;
+            }
+
+            runIndex = 0;
+            return valueDiffIndex + 2;
+        }
 
         const int zeroBits = (8 - valueDiffSize) << 3;
         dataValue = *reinterpret_cast<const value_u64*>(input + valueDiffIndex);
@@ -132,6 +425,11 @@ public:
 
     int read(time_s64* times, value_u64* values) const
     {
+        if (m_isCold)
+        {
+            return readCold(times, values);
+        }
+
         int count = 0;
         const value_u8* input = m_data;
         const value_u8* inputEnd = m_data + m_dataSize;
@@ -141,6 +439,7 @@ public:
 
         value_u8 infoByte = 0;
         value_u64 dataValue = 0;
+        value_u64 timeDiff = 0;
 
         value_u64 timeDiffSize = 0;
         value_u64 valueDiffSize = 0;
@@ -149,13 +448,27 @@ public:
         while (input < inputEnd)
         {
             infoByte = *(input++);
-            timeDiffSize = (infoByte >> 6) + 1;
+            timeDiffSize = timeDiffBytes(infoByte);
             valueDiffSize = infoByte & 0x0F;
 
             dataValue = *reinterpret_cast<const value_u64*>(input);
-            time += dataValue & ((1ULL << (timeDiffSize << 3)) - 1);
+            timeDiff = dataValue & timeDiffMask(timeDiffSize);
+            time += timeDiff;
             input += timeDiffSize;
 
+            if (infoByte & RunFlag)
+            {
+                const int runCount = *reinterpret_cast<const value_u16*>(input);
+                input += 2;
+
+                for (int run = 1; run < runCount; ++run)
+                {
+                    times[count] = time;
+                    values[count++] = value;
+                    time += timeDiff;
+                }
+            }
+
             zeroBitCount = (8 - valueDiffSize) << 3;
             dataValue = *reinterpret_cast<const value_u64*>(input);
             value ^= (dataValue & (-(valueDiffSize != 0))) << zeroBitCount;
@@ -168,7 +481,177 @@ public:
         return count;
     }
 
+    void aggregate(time_s64 beginTime, time_s64 endTime, TimeSeriesAggregate& aggregate) const
+    {
+        if (m_isCold)
+        {
+            aggregateCold(beginTime, endTime, aggregate);
+            return;
+        }
+
+        const value_u8* input = m_data;
+        const value_u8* inputEnd = m_data + m_dataSize;
+
+        time_s64 time = m_beginTime;
+        value_u64 value = m_beginValue;
+
+        if (time >= beginTime && time <= endTime)
+        {
+            aggregate.add(toDouble(value));
+        }
+
+        while (input < inputEnd && time <= endTime)
+        {
+            const value_u8 infoByte = *(input++);
+            const int timeDiffSize = timeDiffBytes(infoByte);
+            const int valueDiffSize = infoByte & 0x0F;
+
+            const time_s64 timeDiff = *reinterpret_cast<const value_u64*>(input) & timeDiffMask(timeDiffSize);
+            input += timeDiffSize;
+
+            if (infoByte & RunFlag)
+            {
+                const time_s64 runCount = *reinterpret_cast<const value_u16*>(input);
+                input += 2;
+
+                const time_s64 firstRun = time + timeDiff >= beginTime ? 1
+                                        : (beginTime - time + timeDiff - 1) / timeDiff;
+                const time_s64 lastRun = time + runCount * timeDiff <= endTime ? runCount
+                                       : (endTime - time) / timeDiff;
+
+                if (lastRun >= firstRun)
+                {
+                    aggregate.add(toDouble(value), static_cast<size_t>(lastRun - firstRun + 1));
+                }
+
+                time += runCount * timeDiff;
+                continue;
+            }
+
+            const int zeroBitCount = (8 - valueDiffSize) << 3;
+            const value_u64 dataValue = *reinterpret_cast<const value_u64*>(input);
+            value ^= valueDiffSize ? (dataValue << zeroBitCount) : 0;
+            input += valueDiffSize;
+            time += timeDiff;
+
+            if (time >= beginTime && time <= endTime)
+            {
+                aggregate.add(toDouble(value));
+            }
+        }
+    }
+
 private:
+    static const value_u8 RunFlag = 0x10;
+    static const value_u8 WideFlag = 0x20;
+
+    static int timeDiffBytes(value_u8 infoByte)
+    {
+        return ((infoByte >> 6) + 1) << ((infoByte >> 5) & 0x01);
+    }
+
+    static value_u64 timeDiffMask(int timeDiffSize)
+    {
+        return -1ULL >> (64 - (timeDiffSize << 3));
+    }
+
+    void commit()
+    {
+        m_committed.store((static_cast<value_u64>(m_dataSize) << 32) | static_cast<value_u64>(m_count),
+                          std::memory_order_release);
+    }
+
+    static value_double toDouble(value_u64 value)
+    {
+        return bitCast<value_double>(value);
+    }
+
+    int readCold(time_s64* times, value_u64* values) const
+    {
+        TimeSeriesColdDecoder decoder(m_data, m_beginTime, m_beginValue);
+        times[0] = m_beginTime;
+        values[0] = m_beginValue;
+
+        for (int index = 1; index < m_count; ++index)
+        {
+            decoder.next(times[index], values[index]);
+        }
+
+        return m_count;
+    }
+
+    int readColdExtent(TimeSeriesBlockReadState& state, int count,
+                       time_s64* times, value_u64* values, int capacity) const
+    {
+        TimeSeriesColdDecoder decoder(m_data, m_beginTime, m_beginValue);
+        time_s64 time = m_beginTime;
+        value_u64 value = m_beginValue;
+        int outCount = 0;
+
+        for (int index = 0; index < count && outCount < capacity; ++index)
+        {
+            if (index > 0)
+            {
+                decoder.next(time, value);
+            }
+            if (index >= state.sampleIndex)
+            {
+                times[outCount] = state.time = time;
+                values[outCount++] = state.value = value;
+                state.sampleIndex = index + 1;
+            }
+        }
+
+        return outCount;
+    }
+
+    void aggregateCold(time_s64 beginTime, time_s64 endTime, TimeSeriesAggregate& aggregate) const
+    {
+        TimeSeriesColdDecoder decoder(m_data, m_beginTime, m_beginValue);
+        time_s64 time = m_beginTime;
+        value_u64 value = m_beginValue;
+
+        for (int index = 0; index < m_count && time <= endTime; ++index)
+        {
+            if (index > 0)
+            {
+                decoder.next(time, value);
+            }
+            if (time >= beginTime && time <= endTime)
+            {
+                aggregate.add(toDouble(value));
+            }
+        }
+    }
+
+    bool appendRun()
+    {
+        value_u8* record = m_data + m_runOffset;
+        value_u16* runCount = reinterpret_cast<value_u16*>(record + timeDiffBytes(record[0]) + 1);
+
+        if (record[0] & RunFlag)
+        {
+            if (*runCount == 0xFFFF)
+            {
+                return false;
+            }
+
+            ++*runCount;
+            return true;
+        }
+
+        if (m_dataSize + 2 + 8 > m_capacity)
+        {
+            return false;
+        }
+
+        *runCount = 2;
+        std::atomic_thread_fence(std::memory_order_release);
+        record[0] |= RunFlag;
+        m_dataSize += 2;
+        return true;
+    }
+
     int countLeadingZeroBits(const time_u32 u32) const
     {
         return u32 ? __builtin_clz(u32) : 64;
@@ -184,26 +667,48 @@ private:
         return u64 ? __builtin_ctzll(u64) : 64;
     };
 
+    int m_count;
     int m_dataSize;
+    int m_capacity;
+    int m_runOffset;
+    value_u64 m_runTimeDiff;
     time_s64 m_beginTime;
     time_s64 m_endTime;
     value_u64 m_beginValue;
     value_u64 m_endValue;
-    value_u8 m_data[BlockSize];
+    bool m_isCold;
+    bool m_isSealed;
+    std::atomic<value_u64> m_committed;
+    value_u8* m_data;
 };
 
 template <int BlockSize>
 class TimeSeriesDataBlock<BlockSize, false>
 {
 public:
+    static const int MaxCount = BlockSize / 16 + 1;
+    static const int PayloadSize = MaxCount * 16;
+
     TimeSeriesDataBlock(time_s64 time, value_u64 value) :
-        m_index(0)
+        m_index(0),
+        m_committedIndex(0),
+        m_capacity(MaxCount),
+        m_isSealed(false),
+        m_times(new time_s64[MaxCount]),
+        m_values(new value_u64[MaxCount])
     {
         m_times[0] = time;
         m_values[0] = value;
     }
 
-    ~TimeSeriesDataBlock() = default;
+    TimeSeriesDataBlock(const TimeSeriesDataBlock&) = delete;
+    TimeSeriesDataBlock& operator=(const TimeSeriesDataBlock&) = delete;
+
+    ~TimeSeriesDataBlock()
+    {
+        delete[] m_times;
+        delete[] m_values;
+    }
 
     time_s64 beginTime() const
     {
@@ -225,6 +730,11 @@ public:
         return m_values[m_index];
     }
 
+    int count() const
+    {
+        return m_index + 1;
+    }
+
     int size() const
     {
         return m_index;
@@ -235,6 +745,57 @@ public:
         return (m_index + 1) * 16;
     }
 
+    void prefetch() const
+    {
+        for (int index = 0; index <= m_index; index += 8)
+        {
+            __builtin_prefetch(m_times + index);
+            __builtin_prefetch(m_values + index);
+        }
+    }
+
+    size_t memorySize() const
+    {
+        return sizeof(*this) + m_capacity * 16;
+    }
+
+    bool isSealed() const
+    {
+        return m_isSealed;
+    }
+
+    bool isCold() const
+    {
+        return false;
+    }
+
+    static TimeSeriesDataBlock* recompress(const TimeSeriesDataBlock*)
+    {
+        return nullptr;
+    }
+
+    void seal()
+    {
+        m_isSealed = true;
+
+        const int capacity = m_index + 1;
+        if (capacity >= m_capacity)
+        {
+            return;
+        }
+
+        time_s64* times = new time_s64[capacity];
+        value_u64* values = new value_u64[capacity];
+        std::memcpy(times, m_times, capacity * sizeof(time_s64));
+        std::memcpy(values, m_values, capacity * sizeof(value_u64));
+        delete[] m_times;
+        delete[] m_values;
+
+        m_times = times;
+        m_values = values;
+        m_capacity = capacity;
+    }
+
     bool append(time_s64 time, value_u64 value)
     {
         if (time <= endTime())
@@ -242,7 +803,7 @@ public:
             return true;
         }
 
-        if (m_index >= (BlockSize / 16))
+        if (m_index + 1 >= m_capacity || m_isSealed)
         {
             return false;
         }
@@ -250,11 +811,67 @@ public:
         m_index++;
         m_times[m_index] = time;
         m_values[m_index] = value;
+        m_committedIndex.store(m_index, std::memory_order_release);
 
         return true;
     }
 
-    int readAtOffset(int offset, time_s64& time, value_u64& value) const
+    void exportImage(TimeSeriesBlockImage& image, value_u8* payload, int fromSize) const
+    {
+        image.beginTime = m_times[0];
+        image.endTime = m_times[m_index];
+        image.beginValue = m_values[0];
+        image.endValue = m_values[m_index];
+        image.count = m_index + 1;
+        image.size = m_index;
+
+        const int count = m_index + 1 - fromSize;
+        std::memcpy(payload + fromSize * sizeof(time_s64), m_times + fromSize, count * sizeof(time_s64));
+        std::memcpy(payload + MaxCount * sizeof(time_s64) + fromSize * sizeof(value_u64),
+                    m_values + fromSize, count * sizeof(value_u64));
+    }
+
+    bool importImage(const TimeSeriesBlockImage& image, const value_u8* payload, int fromSize)
+    {
+        if (image.size < fromSize || image.size >= m_capacity)
+        {
+            return false;
+        }
+
+        const int count = image.size + 1 - fromSize;
+        std::memcpy(m_times + fromSize, payload + fromSize * sizeof(time_s64), count * sizeof(time_s64));
+        std::memcpy(m_values + fromSize, payload + MaxCount * sizeof(time_s64) + fromSize * sizeof(value_u64),
+                    count * sizeof(value_u64));
+
+        m_index = image.size;
+        m_committedIndex.store(m_index, std::memory_order_release);
+        return true;
+    }
+
+    value_u64 committedExtent() const
+    {
+        const value_u64 index = static_cast<value_u64>(m_committedIndex.load(std::memory_order_acquire));
+        return (index << 32) | (index + 1);
+    }
+
+    int readCommitted(TimeSeriesBlockReadState& state, time_s64* times, value_u64* values, int capacity) const
+    {
+        return readExtent(state, committedExtent(), times, values, capacity);
+    }
+
+    int readExtent(TimeSeriesBlockReadState& state, value_u64 extent,
+                   time_s64* times, value_u64* values, int capacity) const
+    {
+        const int count = static_cast<int>(extent & 0xFFFFFFFF) - state.sampleIndex;
+        const int outCount = count < capacity ? count : capacity;
+
+        std::memcpy(times, m_times + state.sampleIndex, outCount * sizeof(time_s64));
+        std::memcpy(values, m_values + state.sampleIndex, outCount * sizeof(value_u64));
+        state.sampleIndex += outCount;
+        return outCount;
+    }
+
+    int readAtOffset(int offset, int&, time_s64& time, value_u64& value) const
     {
         time = m_times[offset + 1];
         value = m_values[offset + 1];
@@ -268,10 +885,26 @@ public:
         return m_index + 1;
     }
 
+    void aggregate(time_s64 beginTime, time_s64 endTime, TimeSeriesAggregate& aggregate) const
+    {
+        const value_double* values = reinterpret_cast<const value_double*>(m_values);
+
+        for (int index = 0; index <= m_index && m_times[index] <= endTime; ++index)
+        {
+            if (m_times[index] >= beginTime)
+            {
+                aggregate.add(values[index]);
+            }
+        }
+    }
+
 private:
     int m_index;
-    mutable time_s64 m_times[BlockSize / 16 + 1];
-    mutable value_u64 m_values[BlockSize / 16 + 1];
+    std::atomic<int> m_committedIndex;
+    int m_capacity;
+    bool m_isSealed;
+    time_s64* m_times;
+    value_u64* m_values;
 };
 
 } // namespace TimeSeries
@@ -23,9 +23,25 @@
 #ifndef TIME_SERIES_DATA_CONTAINER_H
 #define TIME_SERIES_DATA_CONTAINER_H
 
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "timeseriesaggregate.h"
+#include "timeseriesarraystats.h"
 #include "timeseriesarraytypes.h"
+#include "timeseriesblockcache.h"
+#include "timeseriesblockdirectory.h"
 #include "timeseriesdatablock.h"
 #include "timeseriespointerbuffer.h"
+#include "timeseriesquantizer.h"
+#include "timeseriestailnotifier.h"
+#include "timeseriestrace.h"
 
 namespace TimeSeries {
 
@@ -33,24 +49,318 @@ template <int BlockSize, bool Compress>
 class TimeSeriesDataContainer
 {
 public:
-    TimeSeriesDataContainer(time_s64 sizeMillis) : m_sizeMillis(sizeMillis)
+    TimeSeriesDataContainer(time_s64 sizeMillis) :
+        m_sizeMillis(sizeMillis),
+        m_memoryBudget(0),
+        m_memorySize(0),
+        m_firstSequence(0),
+        m_lowestSequence(0),
+        m_coldSequence(0)
     {
     }
 
-    ~TimeSeriesDataContainer() = default;
+    ~TimeSeriesDataContainer()
+    {
+        for (const auto& retiredBlock : m_retiredBlocks)
+        {
+            delete retiredBlock.second;
+        }
+        for (const auto& replacedBlock : m_replacedBlocks)
+        {
+            delete replacedBlock.second;
+        }
+    }
 
     void append(time_s64 time, value_double value)
     {
         const time_s64 MIN_TIME = time - m_sizeMillis;
-        const value_u64 valueIn= *reinterpret_cast<const value_u64*>(&value);
-        while (m_blocks.size() > 1 && m_blocks.at(1)->beginTime() <= MIN_TIME)
+        if (m_quantizer.errorBound() != TimeSeriesErrorBound::None)
         {
-            m_blocks.removeFirst();
+            value = m_quantizer.quantize(value);
+        }
+        const value_u64 valueIn= bitCast<value_u64>(value);
+        if (blockCount() > 0 && time <= m_blocks.last()->endTime())
+        {
+            return;
+        }
+        while (m_directory.size() > 1 && m_directory.at(1).beginTime <= MIN_TIME)
+        {
+            std::lock_guard<std::mutex> lock(m_structureMutex);
+            removeFirstBlock();
+        }
+        if (blockCount() > 0 && m_blocks.last()->append(time, valueIn))
+        {
+            m_tailAggregate.add(value);
+            m_notifier.notify(false);
+            return;
+        }
+
+        {
+            TIME_SERIES_TRACE_SCOPE("append.rollover", blockCount());
+            std::lock_guard<std::mutex> lock(m_structureMutex);
+
+            if (blockCount() > 0)
+            {
+                if (m_blocks.last()->count() >= TimeSeriesDataBlock<BlockSize, Compress>::MaxCount)
+                {
+                    sealBlock(blockCount() - 1);
+                }
+                updateBlockInfo(m_directory.last(), m_blocks.last());
+                setBlockSummary(m_directory.last(), m_tailAggregate);
+            }
+
+            if (!m_replacedBlocks.empty())
+            {
+                releaseReplacedBlocks();
+            }
+
+            appendBlockInfo(new TimeSeriesDataBlock<BlockSize, Compress>(time, valueIn));
+            m_tailAggregate = TimeSeriesAggregate();
+            m_tailAggregate.add(value);
+
+            while (m_memoryBudget > 0 && m_memorySize > m_memoryBudget && m_directory.size() > 1)
+            {
+                removeFirstBlock();
+            }
+        }
+
+        m_notifier.notify(true);
+    }
+
+    void appendBlock(TimeSeriesDataBlock<BlockSize, Compress>* block, sequence_s64 sequence)
+    {
+        std::lock_guard<std::mutex> lock(m_structureMutex);
+
+        if (blockCount() == 0)
+        {
+            m_firstSequence = sequence;
+            m_lowestSequence = std::min(m_lowestSequence, sequence);
+        }
+        else
+        {
+            updateBlockInfo(m_directory.last(), m_blocks.last());
+            setBlockSummary(m_directory.last(), summarizeBlock(m_blocks.last()));
+        }
+
+        appendBlockInfo(block);
+    }
+
+    void removeBlocksBefore(sequence_s64 sequence)
+    {
+        std::lock_guard<std::mutex> lock(m_structureMutex);
+
+        while (blockCount() > 0 && m_firstSequence < sequence)
+        {
+            removeFirstBlock();
+        }
+    }
+
+    void setErrorBound(TimeSeriesErrorBound errorBound, value_double bound)
+    {
+        m_quantizer.setErrorBound(errorBound, bound);
+    }
+
+    TimeSeriesErrorBound errorBound() const
+    {
+        return m_quantizer.errorBound();
+    }
+
+    value_double quantize(value_double value)
+    {
+        return m_quantizer.quantize(value);
+    }
+
+    static void buildBlocks(const time_s64* times, const value_double* values, size_t count,
+                            std::vector<TimeSeriesDataBlock<BlockSize, Compress>*>& blocks)
+    {
+        TimeSeriesDataBlock<BlockSize, Compress>* block = nullptr;
+
+        for (size_t index = 0; index < count; ++index)
+        {
+            const value_u64 value = bitCast<value_u64>(values[index]);
+            if (block && block->append(times[index], value))
+            {
+                continue;
+            }
+
+            if (block)
+            {
+                block->seal();
+            }
+            block = new TimeSeriesDataBlock<BlockSize, Compress>(times[index], value);
+            blocks.push_back(block);
+        }
+
+        if (block)
+        {
+            block->seal();
+        }
+    }
+
+    bool isRetained(time_s64 beginTime, time_s64 endTime) const
+    {
+        if (blockCount() > 0)
+        {
+            endTime = std::max(endTime, m_blocks.last()->endTime());
         }
-        if (blockCount() == 0 || !m_blocks.last()->append(time, valueIn))
+        return beginTime > endTime - m_sizeMillis;
+    }
+
+    bool insertBlocks(const std::vector<TimeSeriesDataBlock<BlockSize, Compress>*>& blocks, bool isEvictable)
+    {
+        if (blocks.empty())
         {
-            m_blocks.append(new TimeSeriesDataBlock<BlockSize, Compress>(time, valueIn));
+            return true;
         }
+
+        std::vector<TimeSeriesAggregate> aggregates;
+        size_t memorySize = 0;
+        for (const TimeSeriesDataBlock<BlockSize, Compress>* block : blocks)
+        {
+            aggregates.push_back(summarizeBlock(block));
+            memorySize += block->memorySize();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_structureMutex);
+
+            const bool isAppend = blockCount() == 0 || blocks.front()->beginTime() > m_blocks.last()->endTime();
+            if (!isAppend && (blocks.back()->endTime() >= m_directory.at(0).beginTime ||
+                              m_firstSequence != m_lowestSequence))
+            {
+                return false;
+            }
+            if (!isEvictable && m_memoryBudget > 0 && memorySize + (isAppend ? 0 : m_memorySize) > m_memoryBudget)
+            {
+                return false;
+            }
+
+            if (isAppend)
+            {
+                if (blockCount() > 0)
+                {
+                    sealBlock(blockCount() - 1);
+                    updateBlockInfo(m_directory.last(), m_blocks.last());
+                    setBlockSummary(m_directory.last(), m_tailAggregate);
+                }
+                for (size_t index = 0; index < blocks.size(); ++index)
+                {
+                    appendBlockInfo(blocks[index]);
+                    setBlockSummary(m_directory.last(), aggregates[index]);
+                }
+                m_tailAggregate = aggregates.back();
+            }
+            else
+            {
+                value_u64 ordinal = m_directory.at(0).ordinal;
+                for (size_t index = blocks.size(); index-- > 0;)
+                {
+                    TimeSeriesBlockInfo info = makeBlockInfo(blocks[index]);
+                    setBlockSummary(info, aggregates[index]);
+                    ordinal -= info.count;
+                    info.ordinal = ordinal;
+
+                    m_blocks.prepend(blocks[index]);
+                    m_directory.prepend(info);
+                    m_memorySize += info.memorySize;
+                    m_firstSequence--;
+                }
+                m_lowestSequence = m_firstSequence;
+                m_coldSequence = m_firstSequence;
+            }
+
+            const time_s64 MIN_TIME = m_blocks.last()->endTime() - m_sizeMillis;
+            while (m_directory.size() > 1 && (m_directory.at(1).beginTime <= MIN_TIME ||
+                                              (m_memoryBudget > 0 && m_memorySize > m_memoryBudget)))
+            {
+                removeFirstBlock();
+            }
+        }
+
+        m_notifier.notify(true);
+        return true;
+    }
+
+    void setMemoryBudget(size_t memoryBudget)
+    {
+        std::lock_guard<std::mutex> lock(m_structureMutex);
+        m_memoryBudget = memoryBudget;
+
+        while (m_memoryBudget > 0 && m_memorySize > m_memoryBudget && m_directory.size() > 1)
+        {
+            removeFirstBlock();
+        }
+    }
+
+    size_t memoryBudget() const
+    {
+        return m_memoryBudget;
+    }
+
+    void compact()
+    {
+        std::lock_guard<std::mutex> lock(m_structureMutex);
+
+        if (blockCount() > 0)
+        {
+            sealBlock(blockCount() - 1);
+        }
+        releaseReplacedBlocks();
+    }
+
+    bool compactColdBlock(time_s64 age)
+    {
+        const TimeSeriesDataBlock<BlockSize, Compress>* block = nullptr;
+        sequence_s64 sequence = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(m_structureMutex);
+
+            sequence = std::max(m_coldSequence, m_firstSequence);
+            const int index = static_cast<int>(sequence - m_firstSequence);
+            if (index + 1 >= blockCount() || m_directory.at(index).endTime > m_directory.last().beginTime - age)
+            {
+                return false;
+            }
+
+            block = m_blocks.at(index);
+            m_coldSequence = sequence + 1;
+            pinBlocks(sequence);
+        }
+
+        TimeSeriesDataBlock<BlockSize, Compress>* coldBlock = TimeSeriesDataBlock<BlockSize, Compress>::recompress(block);
+
+        if (coldBlock)
+        {
+            std::lock_guard<std::mutex> lock(m_structureMutex);
+            installColdBlock(sequence, block, coldBlock);
+        }
+
+        unpinBlocks(sequence);
+        return true;
+    }
+
+    int recompress(time_s64 age)
+    {
+        int count = 0;
+        while (compactColdBlock(age))
+        {
+            ++count;
+        }
+        compact();
+        return count;
+    }
+
+    bool compactIdle(time_s64 currentTime, time_s64 idleTime)
+    {
+        if (blockCount() == 0 || m_blocks.last()->endTime() + idleTime > currentTime)
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_structureMutex);
+        sealBlock(blockCount() - 1);
+        return true;
     }
 
     int blockCount() const
@@ -63,18 +373,306 @@ public:
         return m_blocks.at(index);
     }
 
+    TimeSeriesBlockInfo blockInfo(int index) const
+    {
+        TimeSeriesBlockInfo info = m_directory.at(index);
+        if (index == m_directory.size() - 1)
+        {
+            updateBlockInfo(info, m_blocks.at(index));
+        }
+        return info;
+    }
+
+    int findBlock(time_s64 time) const
+    {
+        return m_directory.findBlock(time);
+    }
+
+    size_t count() const
+    {
+        if (blockCount() == 0)
+        {
+            return 0;
+        }
+        return static_cast<size_t>(m_directory.last().ordinal - m_directory.at(0).ordinal) +
+               m_blocks.last()->count();
+    }
+
+    value_u64 firstOrdinal() const
+    {
+        return blockCount() > 0 ? m_directory.at(0).ordinal : 0;
+    }
+
+    int findOrdinal(value_u64 ordinal) const
+    {
+        return m_directory.findOrdinal(ordinal);
+    }
+
+    sequence_s64 blockSequence(int index) const
+    {
+        return m_firstSequence + index;
+    }
+
+    void enableBlockCache(int blockCount)
+    {
+        if (Compress)
+        {
+            m_cache.reset(blockCount > 0 ? new TimeSeriesBlockCache<BlockSize>(blockCount) : nullptr);
+        }
+    }
+
+    TimeSeriesBlockCache<BlockSize>* blockCache() const
+    {
+        return m_cache.get();
+    }
+
+    std::mutex& structureMutex() const
+    {
+        return m_structureMutex;
+    }
+
+    void pinBlocks(sequence_s64 sequence)
+    {
+        m_pinnedSequences.insert(sequence);
+    }
+
+    void unpinBlocks(sequence_s64 sequence)
+    {
+        std::lock_guard<std::mutex> lock(m_structureMutex);
+        m_pinnedSequences.erase(m_pinnedSequences.find(sequence));
+
+        const sequence_s64 minSequence = m_pinnedSequences.empty() ? std::numeric_limits<sequence_s64>::max()
+                                                                   : *m_pinnedSequences.begin();
+        for (auto retiredBlock = m_retiredBlocks.begin(); retiredBlock != m_retiredBlocks.end();)
+        {
+            if (retiredBlock->first < minSequence)
+            {
+                delete retiredBlock->second;
+                retiredBlock = m_retiredBlocks.erase(retiredBlock);
+            }
+            else
+            {
+                ++retiredBlock;
+            }
+        }
+
+        if (m_pinnedSequences.empty())
+        {
+            for (const sequence_s64 pendingSequence : m_pendingSeals)
+            {
+                const sequence_s64 index = pendingSequence - m_firstSequence;
+                if (index >= 0 && index + 1 < blockCount())
+                {
+                    sealBlock(static_cast<int>(index));
+                }
+            }
+            m_pendingSeals.clear();
+        }
+    }
+
+    TimeSeriesTailNotifier& notifier() const
+    {
+        return m_notifier;
+    }
+
+    TimeSeriesAggregate aggregate(time_s64 beginTime, time_s64 endTime) const
+    {
+        TimeSeriesAggregate aggregate;
+        if (endTime < 0)
+        {
+            endTime = std::numeric_limits<time_s64>::max();
+        }
+
+        for (int index = findBlock(beginTime);
+             index < blockCount() && m_directory.at(index).beginTime <= endTime;
+             ++index)
+        {
+            m_blocks.at(index)->aggregate(beginTime, endTime, aggregate);
+        }
+
+        return aggregate;
+    }
+
     size_t dataSize() const
     {
         size_t size = 0;
-        for (int index = 0; index < m_blocks.size(); ++index) {
-            size += m_blocks.at(index)->dataSize();
+        for (int index = 0; index + 1 < m_directory.size(); ++index) {
+            size += m_directory.at(index).dataSize;
+        }
+        if (m_blocks.size() > 0) {
+            size += m_blocks.last()->dataSize();
         }
         return size;
     }
 
+    TimeSeriesArrayStats stats() const
+    {
+        TimeSeriesArrayStats stats;
+        stats.blockCount = m_directory.size();
+
+        for (int index = 0; index + 1 < m_directory.size(); ++index)
+        {
+            const TimeSeriesBlockInfo& info = m_directory.at(index);
+            stats.sampleCount += info.count;
+            stats.dataSize += info.dataSize;
+            stats.coldBlockCount += m_blocks.at(index)->isCold() ? 1 : 0;
+        }
+
+        stats.memorySize = m_memorySize;
+
+        if (stats.blockCount > 0)
+        {
+            const TimeSeriesBlockInfo info = blockInfo(stats.blockCount - 1);
+            stats.sampleCount += info.count;
+            stats.dataSize += info.dataSize;
+            stats.beginTime = m_directory.at(0).beginTime;
+            stats.endTime = info.endTime;
+            stats.compressionRatio = stats.dataSize / (16.0 * stats.sampleCount);
+        }
+
+        stats.errorBound = m_quantizer.errorBound();
+        stats.bound = m_quantizer.bound();
+        stats.maxAbsoluteError = m_quantizer.maxAbsoluteError();
+        stats.maxRelativeError = m_quantizer.maxRelativeError();
+
+        return stats;
+    }
+
 private:
+    void installColdBlock(sequence_s64 sequence, const TimeSeriesDataBlock<BlockSize, Compress>* block,
+                          TimeSeriesDataBlock<BlockSize, Compress>* coldBlock)
+    {
+        const sequence_s64 index = sequence - m_firstSequence;
+        if (index < 0 || index + 1 >= blockCount() || m_blocks.at(static_cast<int>(index)) != block)
+        {
+            delete coldBlock;
+            return;
+        }
+
+        TimeSeriesBlockInfo& info = m_directory.at(static_cast<int>(index));
+        m_replacedBlocks.push_back(std::make_pair(sequence, m_blocks.replace(static_cast<int>(index), coldBlock)));
+        m_memorySize -= info.memorySize;
+        updateBlockInfo(info, coldBlock);
+        m_memorySize += info.memorySize;
+    }
+
+    void releaseReplacedBlocks()
+    {
+        for (const auto& replacedBlock : m_replacedBlocks)
+        {
+            if (!m_pinnedSequences.empty() && *m_pinnedSequences.begin() <= replacedBlock.first)
+            {
+                m_retiredBlocks.push_back(replacedBlock);
+            }
+            else
+            {
+                delete replacedBlock.second;
+            }
+        }
+        m_replacedBlocks.clear();
+    }
+
+    void appendBlockInfo(TimeSeriesDataBlock<BlockSize, Compress>* block)
+    {
+        const value_u64 ordinal = blockCount() > 0 ? m_directory.last().ordinal + m_directory.last().count : 0;
+
+        m_blocks.append(block);
+        m_directory.append(makeBlockInfo(block));
+        m_directory.last().ordinal = ordinal;
+        m_memorySize += m_directory.last().memorySize;
+    }
+
+    void removeFirstBlock()
+    {
+        TIME_SERIES_TRACE_SCOPE("retention.evict", m_directory.at(0).count);
+        if (m_cache)
+        {
+            m_cache->invalidate(m_firstSequence);
+        }
+        m_memorySize -= m_directory.at(0).memorySize;
+        if (!m_pinnedSequences.empty() && *m_pinnedSequences.begin() <= m_firstSequence)
+        {
+            m_retiredBlocks.push_back(std::make_pair(m_firstSequence, m_blocks.takeFirst()));
+        }
+        else
+        {
+            m_blocks.removeFirst();
+        }
+        m_directory.removeFirst();
+        m_firstSequence++;
+    }
+
+    void sealBlock(int index)
+    {
+        TIME_SERIES_TRACE_SCOPE("block.seal", index);
+        TimeSeriesDataBlock<BlockSize, Compress>* block = m_blocks.at(index);
+        TimeSeriesBlockInfo& info = m_directory.at(index);
+
+        if (!m_pinnedSequences.empty())
+        {
+            m_pendingSeals.push_back(blockSequence(index));
+            return;
+        }
+
+        block->seal();
+        m_memorySize -= info.memorySize;
+        updateBlockInfo(info, block);
+        m_memorySize += info.memorySize;
+    }
+
+    static TimeSeriesBlockInfo makeBlockInfo(const TimeSeriesDataBlock<BlockSize, Compress>* block)
+    {
+        TimeSeriesBlockInfo info;
+        info.beginTime = block->beginTime();
+        info.beginValue = block->beginValue();
+        info.minValue = bitCast<value_double>(info.beginValue);
+        info.maxValue = info.minValue;
+        info.sum = info.minValue;
+        updateBlockInfo(info, block);
+        return info;
+    }
+
+    static TimeSeriesAggregate summarizeBlock(const TimeSeriesDataBlock<BlockSize, Compress>* block)
+    {
+        TimeSeriesAggregate aggregate;
+        block->aggregate(std::numeric_limits<time_s64>::min(), std::numeric_limits<time_s64>::max(), aggregate);
+        return aggregate;
+    }
+
+    static void setBlockSummary(TimeSeriesBlockInfo& info, const TimeSeriesAggregate& aggregate)
+    {
+        info.minValue = aggregate.min;
+        info.maxValue = aggregate.max;
+        info.sum = aggregate.sum;
+    }
+
+    static void updateBlockInfo(TimeSeriesBlockInfo& info,
+                                const TimeSeriesDataBlock<BlockSize, Compress>* block)
+    {
+        info.endTime = block->endTime();
+        info.endValue = block->endValue();
+        info.count = block->count();
+        info.dataSize = static_cast<int>(block->dataSize());
+        info.memorySize = static_cast<int>(block->memorySize());
+    }
+
     time_s64 m_sizeMillis;
+    size_t m_memoryBudget;
+    size_t m_memorySize;
+    sequence_s64 m_firstSequence;
+    sequence_s64 m_lowestSequence;
+    sequence_s64 m_coldSequence;
+    std::unique_ptr<TimeSeriesBlockCache<BlockSize>> m_cache;
+    TimeSeriesAggregate m_tailAggregate;
+    TimeSeriesQuantizer m_quantizer;
     TimeSeriesPointerBuffer<TimeSeriesDataBlock<BlockSize, Compress>> m_blocks;
+    TimeSeriesBlockDirectory m_directory;
+    mutable std::mutex m_structureMutex;
+    std::multiset<sequence_s64> m_pinnedSequences;
+    std::deque<std::pair<sequence_s64, TimeSeriesDataBlock<BlockSize, Compress>*>> m_retiredBlocks;
+    std::vector<std::pair<sequence_s64, TimeSeriesDataBlock<BlockSize, Compress>*>> m_replacedBlocks;
+    std::vector<sequence_s64> m_pendingSeals;
+    mutable TimeSeriesTailNotifier m_notifier;
 };
 
 } // namespace TimeSeries
@@ -24,6 +24,7 @@
 #define TIME_SERIES_DATA_ITERATOR_H
 
 #include "timeseriesarraytypes.h"
+#include "timeseriesblockdecoder.h"
 #include "timeseriesdatablock.h"
 #include "timeseriesdatacontainer.h"
 
@@ -39,6 +40,8 @@ public:
         m_blockCount(0),
         m_blockIndex(0),
         m_blockReadIndex(0),
+        m_blockRunIndex(0),
+        m_decodedCount(0),
         m_block(nullptr),
         m_container(container)
     {
@@ -46,12 +49,16 @@ public:
 
         if (m_blockCount > 0)
         {
-            m_block = container->block(0);
-            m_time = m_block->beginTime();
-            m_value = m_block->beginValue();
+            loadBlock();
+        }
+        else
+        {
+            m_container = nullptr;
         }
     }
 
+    TimeSeriesDataIterator(TimeSeriesDataIterator&&) = default;
+
     virtual ~TimeSeriesDataIterator()
     {
     }
@@ -63,7 +70,7 @@ public:
 
     value_double value() const
     {
-        return *reinterpret_cast<const value_double*>(&m_value);
+        return bitCast<value_double>(m_value);
     }
 
     bool isValid() const
@@ -73,30 +80,61 @@ public:
 
     void next()
     {
-        if (m_blockReadIndex < m_block->size())
+        if (m_decodedCount > 0)
         {
-            m_blockReadIndex += m_block->readAtOffset(m_blockReadIndex, m_time, m_value);
+            if (++m_blockReadIndex < m_decodedCount)
+            {
+                m_time = m_decoder.times()[m_blockReadIndex];
+                m_value = reinterpret_cast<const value_u64*>(m_decoder.values())[m_blockReadIndex];
+                return;
+            }
         }
-        else if (++m_blockIndex >= m_container->blockCount())
+        else if (m_blockReadIndex < m_block->size())
+        {
+            m_blockReadIndex += m_block->readAtOffset(m_blockReadIndex, m_blockRunIndex, m_time, m_value);
+            return;
+        }
+
+        if (++m_blockIndex >= m_container->blockCount())
         {
             m_container = nullptr;
         }
         else
         {
-            m_blockReadIndex = 0;
-            m_block = m_container->block(m_blockIndex);
+            loadBlock();
+        }
+    }
+
+private:
+    void loadBlock()
+    {
+        m_blockReadIndex = 0;
+        m_blockRunIndex = 0;
+        m_block = m_container->block(m_blockIndex);
+
+        if (Compress && (m_container->blockCache() || m_block->isCold()))
+        {
+            m_decodedCount = m_decoder.decode(m_container, m_blockIndex);
+            m_time = m_decoder.times()[0];
+            m_value = reinterpret_cast<const value_u64*>(m_decoder.values())[0];
+        }
+        else
+        {
+            m_decodedCount = 0;
             m_time = m_block->beginTime();
             m_value = m_block->beginValue();
         }
     }
 
-private:
     time_s64 m_time;
     value_u64 m_value;
 
     int m_blockCount;
     int m_blockIndex;
     int m_blockReadIndex;
+    int m_blockRunIndex;
+    int m_decodedCount;
+    TimeSeriesBlockDecoder<BlockSize, Compress> m_decoder;
     const TimeSeriesDataBlock<BlockSize, Compress>* m_block;
     const TimeSeriesDataContainer<BlockSize, Compress>* m_container;
 };
@@ -23,9 +23,13 @@
 #ifndef TIME_SERIES_DATA_RANGE_H
 #define TIME_SERIES_DATA_RANGE_H
 
+#include <algorithm>
+
 #include "timeseriesarraytypes.h"
+#include "timeseriesblockdecoder.h"
 #include "timeseriesdatablock.h"
 #include "timeseriesdatacontainer.h"
+#include "timeseriestimeunit.h"
 
 namespace TimeSeries {
 
@@ -34,13 +38,20 @@ class TimeSeriesDataRange
 {
 public:
     TimeSeriesDataRange(const TimeSeriesDataContainer<BlockSize, Compress>* container,
-                        time_s64 beginTime, time_s64 endTime) :
+                        time_s64 beginTime, time_s64 endTime,
+                        TimeSeriesTimeUnit timeUnit = TimeSeriesTimeUnit::Milliseconds) :
         m_beginTime(beginTime),
         m_endTime(endTime),
+        m_timeUnit(timeUnit),
         m_container(container)
     {
     }
 
+    TimeSeriesTimeUnit timeUnit() const
+    {
+        return m_timeUnit;
+    }
+
     ~TimeSeriesDataRange() = default;
 
     class Iterator
@@ -54,9 +65,7 @@ public:
             m_count(0),
             m_index(0),
             m_times(nullptr),
-            m_timesAlloc(nullptr),
             m_values(nullptr),
-            m_valuesAlloc(nullptr),
             m_blockIndex(0),
             m_container(container)
         {
@@ -65,39 +74,23 @@ public:
                 m_container = nullptr;
             }
 
-            while (m_container && m_blockIndex < m_container->blockCount())
+            if (m_container && m_container->blockCount() > 0 &&
+                m_container->blockInfo(m_container->blockCount() - 1).endTime >= m_beginTime)
             {
-                const auto block = m_container->block(m_blockIndex);
+                m_blockIndex = m_container->findBlock(m_beginTime);
+                decode();
 
-                if (block->endTime() >= m_endTime)
+                while (m_index + 1 < m_count && m_times[m_index + 1] <= m_beginTime)
                 {
-                    m_timesAlloc = m_times = new time_s64[BlockSize / 2 + 1];
-                    m_valuesAlloc = m_values = new value_double[BlockSize / 2 + 1];
-                    m_count = block->read(m_times, reinterpret_cast<value_u64*&>(m_values));
-
-                    while (m_index + 1 < m_count && m_times[m_index + 1] <= m_beginTime)
-                    {
-                        ++m_index;
-                    }
-
-                    break;
+                    ++m_index;
                 }
-
-                m_blockIndex++;
             }
-
-            if (m_container && m_blockIndex >= m_container->blockCount())
+            else
             {
                 m_container = nullptr;
             }
         }
 
-        ~Iterator()
-        {
-            delete[] m_timesAlloc;
-            delete[] m_valuesAlloc;
-        }
-
         time_s64 time() const
         {
             return m_times[m_index];
@@ -122,8 +115,7 @@ public:
                 }
                 else
                 {
-                    const auto block = m_container->block(m_blockIndex);
-                    m_count = block->read(m_times, reinterpret_cast<value_u64*&>(m_values));
+                    decode();
                     m_index = 0;
                 }
             }
@@ -142,33 +134,81 @@ public:
         }
 
     private:
+        void decode()
+        {
+            m_count = m_decoder.decode(m_container, m_blockIndex);
+            m_times = m_decoder.times();
+            m_values = m_decoder.values();
+        }
+
         time_s64 m_beginTime;
         time_s64 m_endTime;
 
         int m_count;
         int m_index;
-        time_s64* m_times;
-        time_s64* m_timesAlloc;
-        value_double* m_values;
-        value_double* m_valuesAlloc;
+        const time_s64* m_times;
+        const value_double* m_values;
+        TimeSeriesBlockDecoder<BlockSize, Compress> m_decoder;
 
         int m_blockIndex;
         const TimeSeriesDataContainer<BlockSize, Compress>* m_container;
     };
 
-    const Iterator begin() const
+    Iterator begin() const
     {
         return Iterator(m_container, m_beginTime, m_endTime);
     }
 
-    const Iterator end() const
+    Iterator end() const
     {
         return Iterator(m_container, -1, -1);
     }
 
+    template <class Function>
+    void forEach(Function&& function) const
+    {
+        const int blockCount = m_container->blockCount();
+        if (blockCount == 0 || m_container->blockInfo(blockCount - 1).endTime < m_beginTime)
+        {
+            return;
+        }
+
+        TimeSeriesBlockDecoder<BlockSize, Compress> decoder;
+
+        for (int blockIndex = m_container->findBlock(m_beginTime); blockIndex < blockCount; ++blockIndex)
+        {
+            const int count = decoder.decode(m_container, blockIndex);
+            const time_s64* times = decoder.times();
+            const value_double* values = decoder.values();
+
+            int index = 0;
+            while (index + 1 < count && times[index + 1] <= m_beginTime)
+            {
+                ++index;
+            }
+
+            int endIndex = count;
+            if (m_endTime >= 0)
+            {
+                endIndex = static_cast<int>(std::lower_bound(times + index, times + count, m_endTime) - times);
+            }
+
+            for (const int lastIndex = std::min(endIndex + 1, count); index < lastIndex; ++index)
+            {
+                function(times[index], values[index]);
+            }
+
+            if (endIndex < count)
+            {
+                return;
+            }
+        }
+    }
+
 private:
     time_s64 m_beginTime;
     time_s64 m_endTime;
+    TimeSeriesTimeUnit m_timeUnit;
     const TimeSeriesDataContainer<BlockSize, Compress>* m_container;
 };
 
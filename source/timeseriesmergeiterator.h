@@ -0,0 +1,324 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef TIME_SERIES_MERGE_ITERATOR_H
+#define TIME_SERIES_MERGE_ITERATOR_H
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "timeseriesarraytypes.h"
+#include "timeseriesblockdecoder.h"
+#include "timeseriesdatacontainer.h"
+
+namespace TimeSeries {
+
+enum class TimeSeriesJoin
+{
+    Outer,
+    Inner,
+    AsOf
+};
+
+template <int BlockSize, bool Compress>
+class TimeSeriesMergeIterator
+{
+public:
+    TimeSeriesMergeIterator(const TimeSeriesDataContainer<BlockSize, Compress>* const* containers,
+                            int containerCount, TimeSeriesJoin join,
+                            time_s64 beginTime = 0, time_s64 endTime = -1) :
+        m_join(join),
+        m_time(0),
+        m_endTime(endTime < 0 ? std::numeric_limits<time_s64>::max() : endTime),
+        m_isValid(containerCount > 0),
+        m_heads(containerCount),
+        m_present(containerCount),
+        m_values(containerCount)
+    {
+        m_cursors.reserve(containerCount);
+
+        for (int index = 0; index < containerCount; ++index)
+        {
+            m_cursors.push_back(Cursor(containers[index]));
+            Cursor& cursor = m_cursors.back();
+
+            if (cursor.container->blockCount() > 0)
+            {
+                cursor.blockIndex = cursor.container->findBlock(beginTime);
+                cursor.decode();
+
+                if (m_join != TimeSeriesJoin::AsOf || index == 0)
+                {
+                    cursor.seek(beginTime);
+                }
+            }
+
+            m_heads[index] = cursor.head();
+        }
+
+        next();
+    }
+
+    bool isValid() const
+    {
+        return m_isValid;
+    }
+
+    time_s64 time() const
+    {
+        return m_time;
+    }
+
+    int count() const
+    {
+        return static_cast<int>(m_cursors.size());
+    }
+
+    bool hasValue(int index) const
+    {
+        return m_present[index] != 0;
+    }
+
+    value_double value(int index) const
+    {
+        return m_values[index];
+    }
+
+    void next()
+    {
+        if (!m_isValid)
+        {
+            return;
+        }
+
+        switch (m_join)
+        {
+        case TimeSeriesJoin::Outer:
+            nextOuter();
+            break;
+        case TimeSeriesJoin::Inner:
+            nextInner();
+            break;
+        case TimeSeriesJoin::AsOf:
+            nextAsOf();
+            break;
+        }
+
+        if (m_isValid && m_time > m_endTime)
+        {
+            m_isValid = false;
+        }
+    }
+
+private:
+    static const time_s64 EndOfData = std::numeric_limits<time_s64>::max();
+
+    struct Cursor
+    {
+        Cursor(const TimeSeriesDataContainer<BlockSize, Compress>* container) :
+            container(container),
+            times(nullptr),
+            values(nullptr),
+            index(0),
+            count(0),
+            blockIndex(0)
+        {
+        }
+
+        time_s64 head() const
+        {
+            return index < count ? times[index] : EndOfData;
+        }
+
+        void decode()
+        {
+            count = decoder.decode(container, blockIndex);
+            times = decoder.times();
+            values = decoder.values();
+            index = 0;
+        }
+
+        void advance()
+        {
+            if (++index >= count && blockIndex + 1 < container->blockCount())
+            {
+                ++blockIndex;
+                decode();
+            }
+        }
+
+        void seek(time_s64 time)
+        {
+            int targetIndex = blockIndex;
+            while (targetIndex + 1 < container->blockCount() &&
+                   container->blockInfo(targetIndex).endTime < time)
+            {
+                ++targetIndex;
+            }
+
+            if (targetIndex != blockIndex)
+            {
+                blockIndex = targetIndex;
+                decode();
+            }
+
+            index = static_cast<int>(std::lower_bound(times + index, times + count, time) - times);
+        }
+
+        const TimeSeriesDataContainer<BlockSize, Compress>* container;
+        TimeSeriesBlockDecoder<BlockSize, Compress> decoder;
+        const time_s64* times;
+        const value_double* values;
+        int index;
+        int count;
+        int blockIndex;
+    };
+
+    time_s64 minHead() const
+    {
+        const time_s64* heads = m_heads.data();
+        const int headCount = static_cast<int>(m_heads.size());
+        time_s64 time = EndOfData;
+
+        for (int index = 0; index < headCount; ++index)
+        {
+            time = heads[index] < time ? heads[index] : time;
+        }
+
+        return time;
+    }
+
+    time_s64 maxHead() const
+    {
+        const time_s64* heads = m_heads.data();
+        const int headCount = static_cast<int>(m_heads.size());
+        time_s64 time = std::numeric_limits<time_s64>::min();
+
+        for (int index = 0; index < headCount; ++index)
+        {
+            time = heads[index] > time ? heads[index] : time;
+        }
+
+        return time;
+    }
+
+    void take(int index)
+    {
+        Cursor& cursor = m_cursors[index];
+        m_present[index] = 1;
+        m_values[index] = cursor.values[cursor.index];
+        cursor.advance();
+        m_heads[index] = cursor.head();
+    }
+
+    void nextOuter()
+    {
+        m_time = minHead();
+        if (m_time == EndOfData)
+        {
+            m_isValid = false;
+            return;
+        }
+
+        for (int index = 0; index < count(); ++index)
+        {
+            m_present[index] = 0;
+            if (m_heads[index] == m_time)
+            {
+                take(index);
+            }
+        }
+    }
+
+    void nextInner()
+    {
+        for (;;)
+        {
+            const time_s64 time = maxHead();
+            if (time == EndOfData || time > m_endTime)
+            {
+                m_isValid = false;
+                return;
+            }
+
+            bool isAligned = true;
+            for (int index = 0; index < count(); ++index)
+            {
+                if (m_heads[index] < time)
+                {
+                    m_cursors[index].seek(time);
+                    m_heads[index] = m_cursors[index].head();
+                }
+                isAligned &= m_heads[index] == time;
+            }
+
+            if (isAligned)
+            {
+                m_time = time;
+                for (int index = 0; index < count(); ++index)
+                {
+                    take(index);
+                }
+                return;
+            }
+        }
+    }
+
+    void nextAsOf()
+    {
+        m_time = m_heads[0];
+        if (m_time == EndOfData)
+        {
+            m_isValid = false;
+            return;
+        }
+
+        take(0);
+
+        for (int index = 1; index < count(); ++index)
+        {
+            while (m_heads[index] <= m_time)
+            {
+                Cursor& cursor = m_cursors[index];
+                cursor.index = static_cast<int>(std::upper_bound(cursor.times + cursor.index,
+                                                                 cursor.times + cursor.count,
+                                                                 m_time) - cursor.times) - 1;
+                take(index);
+            }
+        }
+    }
+
+    TimeSeriesJoin m_join;
+    time_s64 m_time;
+    time_s64 m_endTime;
+    bool m_isValid;
+    std::vector<Cursor> m_cursors;
+    std::vector<time_s64> m_heads;
+    std::vector<char> m_present;
+    std::vector<value_double> m_values;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_MERGE_ITERATOR_H
@@ -0,0 +1,145 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_MPSC_QUEUE_H
+#define TIME_SERIES_MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace TimeSeries {
+
+template <class ItemType>
+class TimeSeriesMpscQueue
+{
+public:
+    TimeSeriesMpscQueue(int capacity) :
+        m_capacity(roundUpToPowerOfTwo(capacity)),
+        m_mask(m_capacity - 1),
+        m_cells(new Cell[m_capacity]),
+        m_head(0),
+        m_tail(0)
+    {
+        for (size_t index = 0; index < m_capacity; ++index)
+        {
+            m_cells[index].sequence.store(index, std::memory_order_relaxed);
+        }
+    }
+
+    TimeSeriesMpscQueue(const TimeSeriesMpscQueue&) = delete;
+    TimeSeriesMpscQueue& operator=(const TimeSeriesMpscQueue&) = delete;
+
+    ~TimeSeriesMpscQueue()
+    {
+        delete[] m_cells;
+    }
+
+    bool push(const ItemType& item)
+    {
+        size_t position = m_tail.load(std::memory_order_relaxed);
+        Cell* cell;
+
+        for (;;)
+        {
+            cell = &m_cells[position & m_mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence - position);
+
+            if (diff == 0)
+            {
+                if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->item = item;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    int pop(ItemType* items, int capacity)
+    {
+        int count = 0;
+
+        while (count < capacity)
+        {
+            Cell& cell = m_cells[m_head & m_mask];
+            if (cell.sequence.load(std::memory_order_acquire) != m_head + 1)
+            {
+                break;
+            }
+
+            items[count++] = cell.item;
+            cell.sequence.store(m_head + m_capacity, std::memory_order_release);
+            m_head++;
+        }
+
+        return count;
+    }
+
+    size_t pushCount() const
+    {
+        return m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    static const int CacheLineSize = 64;
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        ItemType item;
+    };
+
+    static size_t roundUpToPowerOfTwo(int value)
+    {
+        size_t result = 2;
+        while (result < static_cast<size_t>(value))
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t m_capacity;
+    const size_t m_mask;
+    Cell* m_cells;
+    char m_headPadding[CacheLineSize];
+    size_t m_head;
+    char m_tailPadding[CacheLineSize - sizeof(size_t)];
+    std::atomic<size_t> m_tail;
+    char m_endPadding[CacheLineSize - sizeof(std::atomic<size_t>)];
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_MPSC_QUEUE_H
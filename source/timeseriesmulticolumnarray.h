@@ -0,0 +1,249 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_MULTI_COLUMN_ARRAY_H
+#define TIME_SERIES_MULTI_COLUMN_ARRAY_H
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "timeseriesaggregate.h"
+#include "timeseriesarraystats.h"
+#include "timeseriesarraytypes.h"
+#include "timeseriesblockdirectory.h"
+#include "timeseriesmulticolumnblock.h"
+#include "timeseriespointerbuffer.h"
+
+namespace TimeSeries {
+
+template <int Columns>
+struct TimeSeriesColumnSpans
+{
+    int count;
+    const time_s64* times;
+    const value_double* columns[Columns];
+};
+
+template <int Columns, int BlockSize = 8192>
+class TimeSeriesMultiColumnArray
+{
+public:
+    typedef TimeSeriesMultiColumnBlock<BlockSize, Columns> Block;
+
+    TimeSeriesMultiColumnArray(time_s64 sizeMillis) :
+        m_sizeMillis(sizeMillis),
+        m_memorySize(0)
+    {
+    }
+
+    TimeSeriesMultiColumnArray(const TimeSeriesMultiColumnArray&) = delete;
+    TimeSeriesMultiColumnArray& operator=(const TimeSeriesMultiColumnArray&) = delete;
+
+    void append(time_s64 time, const value_double* values)
+    {
+        const time_s64 MIN_TIME = time - m_sizeMillis;
+        while (m_directory.size() > 1 && m_directory.at(1).beginTime <= MIN_TIME)
+        {
+            m_memorySize -= m_directory.at(0).memorySize;
+            m_blocks.removeFirst();
+            m_directory.removeFirst();
+        }
+
+        if (m_blocks.size() > 0 && m_blocks.last()->append(time, values))
+        {
+            return;
+        }
+
+        TimeSeriesBlockInfo info = TimeSeriesBlockInfo();
+        if (m_blocks.size() > 0)
+        {
+            m_blocks.last()->seal();
+            m_memorySize -= m_directory.last().memorySize;
+            updateBlockInfo(m_directory.last(), m_blocks.last());
+            m_memorySize += m_directory.last().memorySize;
+            info.ordinal = m_directory.last().ordinal + m_directory.last().count;
+        }
+
+        m_blocks.append(new Block(time, values));
+        info.beginTime = time;
+        updateBlockInfo(info, m_blocks.last());
+        m_directory.append(info);
+        m_memorySize += info.memorySize;
+    }
+
+    int columnCount() const
+    {
+        return Columns;
+    }
+
+    int blockCount() const
+    {
+        return m_blocks.size();
+    }
+
+    template <class Function>
+    void forEachBlock(time_s64 beginTime, time_s64 endTime, Function&& function) const
+    {
+        if (m_blocks.size() == 0 || m_blocks.last()->endTime() < beginTime)
+        {
+            return;
+        }
+
+        std::vector<time_s64> times(Block::MaxCount);
+        std::vector<value_double> values(Block::MaxCount * Columns);
+
+        for (int blockIndex = m_directory.findBlock(beginTime); blockIndex < m_blocks.size(); ++blockIndex)
+        {
+            const Block* block = m_blocks.at(blockIndex);
+            const int count = block->count();
+            TimeSeriesColumnSpans<Columns> spans;
+
+            block->readTimes(times.data());
+            spans.times = times.data();
+            for (int column = 0; column < Columns; ++column)
+            {
+                block->readColumn(column, values.data() + column * Block::MaxCount);
+                spans.columns[column] = values.data() + column * Block::MaxCount;
+            }
+
+            int index = static_cast<int>(std::upper_bound(spans.times, spans.times + count, beginTime) - spans.times);
+            index = std::max(index - 1, 0);
+
+            int endIndex = count;
+            if (endTime >= 0)
+            {
+                endIndex = static_cast<int>(std::lower_bound(spans.times + index, spans.times + count, endTime) -
+                                            spans.times);
+            }
+
+            spans.count = std::min(endIndex + 1, count) - index;
+            spans.times += index;
+            for (int column = 0; column < Columns; ++column)
+            {
+                spans.columns[column] += index;
+            }
+            function(spans);
+
+            if (endIndex < count)
+            {
+                return;
+            }
+            beginTime = std::numeric_limits<time_s64>::min();
+        }
+    }
+
+    template <class Function>
+    void forEach(time_s64 beginTime, time_s64 endTime, Function&& function) const
+    {
+        value_double row[Columns];
+        forEachBlock(beginTime, endTime, [&](const TimeSeriesColumnSpans<Columns>& spans) {
+            for (int index = 0; index < spans.count; ++index)
+            {
+                for (int column = 0; column < Columns; ++column)
+                {
+                    row[column] = spans.columns[column][index];
+                }
+                function(spans.times[index], static_cast<const value_double*>(row));
+            }
+        });
+    }
+
+    TimeSeriesAggregate aggregate(int column, time_s64 beginTime = 0, time_s64 endTime = -1) const
+    {
+        TimeSeriesAggregate aggregate;
+        if (endTime < 0)
+        {
+            endTime = std::numeric_limits<time_s64>::max();
+        }
+
+        std::vector<time_s64> times(Block::MaxCount);
+        std::vector<value_double> values(Block::MaxCount);
+
+        for (int blockIndex = m_blocks.size() > 0 ? m_directory.findBlock(beginTime) : 0;
+             blockIndex < m_blocks.size() && m_directory.at(blockIndex).beginTime <= endTime;
+             ++blockIndex)
+        {
+            const Block* block = m_blocks.at(blockIndex);
+            block->readTimes(times.data());
+            block->readColumn(column, values.data());
+
+            for (int index = 0; index < block->count(); ++index)
+            {
+                if (times[index] >= beginTime && times[index] <= endTime)
+                {
+                    aggregate.add(values[index]);
+                }
+            }
+        }
+
+        return aggregate;
+    }
+
+    size_t dataSize() const
+    {
+        size_t size = 0;
+        for (int index = 0; index < m_blocks.size(); ++index)
+        {
+            size += m_blocks.at(index)->dataSize();
+        }
+        return size;
+    }
+
+    TimeSeriesArrayStats stats() const
+    {
+        TimeSeriesArrayStats stats;
+        stats.blockCount = m_blocks.size();
+        stats.dataSize = dataSize();
+        stats.memorySize = m_memorySize;
+
+        if (stats.blockCount > 0)
+        {
+            stats.memorySize += m_blocks.last()->memorySize() - m_directory.last().memorySize;
+            stats.sampleCount = static_cast<size_t>(m_directory.last().ordinal - m_directory.at(0).ordinal) +
+                                m_blocks.last()->count();
+            stats.beginTime = m_blocks.at(0)->beginTime();
+            stats.endTime = m_blocks.last()->endTime();
+            stats.compressionRatio = stats.dataSize / (8.0 * (Columns + 1) * stats.sampleCount);
+        }
+
+        return stats;
+    }
+
+private:
+    static void updateBlockInfo(TimeSeriesBlockInfo& info, const Block* block)
+    {
+        info.endTime = block->endTime();
+        info.count = block->count();
+        info.dataSize = static_cast<int>(block->dataSize());
+        info.memorySize = static_cast<int>(block->memorySize());
+    }
+
+    time_s64 m_sizeMillis;
+    size_t m_memorySize;
+    TimeSeriesPointerBuffer<Block> m_blocks;
+    TimeSeriesBlockDirectory m_directory;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_MULTI_COLUMN_ARRAY_H
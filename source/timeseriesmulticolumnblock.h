@@ -0,0 +1,269 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_MULTI_COLUMN_BLOCK_H
+#define TIME_SERIES_MULTI_COLUMN_BLOCK_H
+
+#include <cstring>
+#include <vector>
+
+#include "timeseriesarraytypes.h"
+
+namespace TimeSeries {
+
+template <int BlockSize, int Columns>
+class TimeSeriesMultiColumnBlock
+{
+public:
+    static const int MaxCount = BlockSize / 8;
+
+    TimeSeriesMultiColumnBlock(time_s64 time, const value_double* values) :
+        m_count(0),
+        m_dataSize(0),
+        m_beginTime(time),
+        m_endTime(time),
+        m_data(nullptr)
+    {
+        for (int stream = 0; stream <= Columns; ++stream)
+        {
+            m_streams[stream].reserve(BlockSize / (Columns + 1));
+        }
+        for (int column = 0; column < Columns; ++column)
+        {
+            m_values[column] = 0;
+        }
+        appendRow(time, values);
+    }
+
+    TimeSeriesMultiColumnBlock(const TimeSeriesMultiColumnBlock&) = delete;
+    TimeSeriesMultiColumnBlock& operator=(const TimeSeriesMultiColumnBlock&) = delete;
+
+    ~TimeSeriesMultiColumnBlock()
+    {
+        delete[] m_data;
+    }
+
+    time_s64 beginTime() const
+    {
+        return m_beginTime;
+    }
+
+    time_s64 endTime() const
+    {
+        return m_endTime;
+    }
+
+    int count() const
+    {
+        return m_count;
+    }
+
+    size_t dataSize() const
+    {
+        if (isSealed())
+        {
+            return 8 + m_dataSize;
+        }
+
+        size_t size = 8;
+        for (const auto& stream : m_streams)
+        {
+            size += stream.size();
+        }
+        return size;
+    }
+
+    size_t memorySize() const
+    {
+        if (isSealed())
+        {
+            return sizeof(*this) + m_dataSize;
+        }
+
+        size_t size = sizeof(*this);
+        for (const auto& stream : m_streams)
+        {
+            size += stream.capacity();
+        }
+        return size;
+    }
+
+    bool isSealed() const
+    {
+        return m_data != nullptr;
+    }
+
+    bool append(time_s64 time, const value_double* values)
+    {
+        if (time <= m_endTime)
+        {
+            return true;
+        }
+
+        if (m_count >= MaxCount || isSealed() || dataSize() - 8 + MaxRowSize > BlockSize)
+        {
+            return false;
+        }
+
+        appendRow(time, values);
+        return true;
+    }
+
+    void seal()
+    {
+        if (isSealed())
+        {
+            return;
+        }
+
+        m_dataSize = static_cast<int>(dataSize()) - 8;
+        m_data = new value_u8[m_dataSize + 1];
+
+        int offset = 0;
+        for (int stream = 0; stream <= Columns; ++stream)
+        {
+            if (stream > 0)
+            {
+                m_offsets[stream - 1] = offset;
+            }
+            std::memcpy(m_data + offset, m_streams[stream].data(), m_streams[stream].size());
+            offset += static_cast<int>(m_streams[stream].size());
+            std::vector<value_u8>().swap(m_streams[stream]);
+        }
+    }
+
+    int readTimes(time_s64* times) const
+    {
+        const value_u8* input = isSealed() ? m_data : m_streams[0].data();
+        time_s64 time = times[0] = m_beginTime;
+
+        for (int index = 1; index < m_count; ++index)
+        {
+            value_u64 timeDiff = 0;
+            for (int shift = 0;; shift += 7)
+            {
+                const value_u8 byte = *(input++);
+                timeDiff |= static_cast<value_u64>(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                {
+                    break;
+                }
+            }
+            time += timeDiff;
+            times[index] = time;
+        }
+
+        return m_count;
+    }
+
+    int readColumn(int column, value_double* values) const
+    {
+        const value_u8* input = isSealed() ? m_data + m_offsets[column] : m_streams[column + 1].data();
+        value_u64 value = 0;
+
+        for (int index = 0; index < m_count; ++index)
+        {
+            const value_u8 header = *(input++);
+            const int byteCount = header & 0x0F;
+            value_u64 valueDiff = 0;
+            for (int byte = 0; byte < byteCount; ++byte)
+            {
+                valueDiff |= static_cast<value_u64>(input[byte]) << (byte << 3);
+            }
+            input += byteCount;
+
+            value ^= valueDiff << ((header >> 4) << 3);
+            std::memcpy(values + index, &value, sizeof(value));
+        }
+
+        return m_count;
+    }
+
+private:
+    static const int MaxRowSize = 10 + Columns * 9;
+
+    void appendRow(time_s64 time, const value_double* values)
+    {
+        if (m_count > 0)
+        {
+            std::vector<value_u8>& stream = m_streams[0];
+            const size_t size = stream.size();
+            stream.resize(size + 10);
+
+            value_u8* output = stream.data() + size;
+            value_u64 timeDiff = static_cast<value_u64>(time - m_endTime);
+            for (; timeDiff >= 0x80; timeDiff >>= 7)
+            {
+                *(output++) = static_cast<value_u8>(timeDiff | 0x80);
+            }
+            *(output++) = static_cast<value_u8>(timeDiff);
+            stream.resize(output - stream.data());
+        }
+
+        for (int column = 0; column < Columns; ++column)
+        {
+            std::vector<value_u8>& stream = m_streams[column + 1];
+            const size_t size = stream.size();
+            stream.resize(size + 9);
+
+            value_u8* output = stream.data() + size;
+            value_u64 value;
+            std::memcpy(&value, values + column, sizeof(value));
+
+            value_u64 valueDiff = value ^ m_values[column];
+            m_values[column] = value;
+            if (!valueDiff)
+            {
+                *(output++) = 0;
+            }
+            else
+            {
+                const int trailingBytes = __builtin_ctzll(valueDiff) >> 3;
+                const int byteCount = 8 - (__builtin_clzll(valueDiff) >> 3) - trailingBytes;
+                valueDiff >>= trailingBytes << 3;
+
+                *(output++) = static_cast<value_u8>((trailingBytes << 4) | byteCount);
+                for (int byte = 0; byte < byteCount; ++byte, valueDiff >>= 8)
+                {
+                    *(output++) = static_cast<value_u8>(valueDiff);
+                }
+            }
+            stream.resize(output - stream.data());
+        }
+
+        m_endTime = time;
+        m_count++;
+    }
+
+    int m_count;
+    int m_dataSize;
+    int m_offsets[Columns];
+    time_s64 m_beginTime;
+    time_s64 m_endTime;
+    value_u64 m_values[Columns];
+    std::vector<value_u8> m_streams[Columns + 1];
+    value_u8* m_data;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_MULTI_COLUMN_BLOCK_H
@@ -0,0 +1,358 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef TIME_SERIES_PIPELINE_H
+#define TIME_SERIES_PIPELINE_H
+
+#include <chrono>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "timeseriesarraytypes.h"
+#include "timeseriesdatarange.h"
+#include "timeseriestimeunit.h"
+
+namespace TimeSeries {
+
+enum class TimeSeriesRolling
+{
+    Min,
+    Max,
+    Sum,
+    Mean
+};
+
+class TimeSeriesRate
+{
+public:
+    TimeSeriesRate(std::chrono::duration<value_double> period, bool isCounter) :
+        m_period(period),
+        m_timeUnit(period.count() * timeUnitsPerSecond(TimeSeriesTimeUnit::Milliseconds)),
+        m_isCounter(isCounter),
+        m_hasPrevious(false),
+        m_previousTime(0),
+        m_previousValue(0.0)
+    {
+    }
+
+    void setTimeUnit(TimeSeriesTimeUnit timeUnit)
+    {
+        m_timeUnit = m_period.count() * timeUnitsPerSecond(timeUnit);
+    }
+
+    template <class Sink>
+    void push(time_s64 time, value_double value, Sink& sink)
+    {
+        if (m_hasPrevious)
+        {
+            value_double delta = value - m_previousValue;
+            if (m_isCounter && delta < 0.0)
+            {
+                delta = value;
+            }
+            sink(time, delta * m_timeUnit / static_cast<value_double>(time - m_previousTime));
+        }
+
+        m_hasPrevious = true;
+        m_previousTime = time;
+        m_previousValue = value;
+    }
+
+private:
+    std::chrono::duration<value_double> m_period;
+    value_double m_timeUnit;
+    bool m_isCounter;
+    bool m_hasPrevious;
+    time_s64 m_previousTime;
+    value_double m_previousValue;
+};
+
+class TimeSeriesEwma
+{
+public:
+    TimeSeriesEwma(value_double alpha) :
+        m_alpha(alpha),
+        m_hasValue(false),
+        m_value(0.0)
+    {
+    }
+
+    template <class Sink>
+    void push(time_s64 time, value_double value, Sink& sink)
+    {
+        m_value = m_hasValue ? m_value + m_alpha * (value - m_value) : value;
+        m_hasValue = true;
+        sink(time, m_value);
+    }
+
+private:
+    value_double m_alpha;
+    bool m_hasValue;
+    value_double m_value;
+};
+
+template <class Type>
+class TimeSeriesRingBuffer
+{
+public:
+    TimeSeriesRingBuffer(int capacity) :
+        m_items(capacity > 0 ? capacity : 1),
+        m_first(0),
+        m_size(0)
+    {
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    const Type& front() const
+    {
+        return m_items[m_first];
+    }
+
+    const Type& back() const
+    {
+        return m_items[(m_first + m_size - 1) % m_items.size()];
+    }
+
+    void push_back(const Type& item)
+    {
+        if (m_size == m_items.size())
+        {
+            std::vector<Type> items(m_items.size() * 2);
+            for (size_t index = 0; index < m_size; ++index)
+            {
+                items[index] = m_items[(m_first + index) % m_items.size()];
+            }
+            m_items.swap(items);
+            m_first = 0;
+        }
+        m_items[(m_first + m_size) % m_items.size()] = item;
+        m_size++;
+    }
+
+    void pop_front()
+    {
+        m_first = (m_first + 1) % m_items.size();
+        m_size--;
+    }
+
+    void pop_back()
+    {
+        m_size--;
+    }
+
+private:
+    std::vector<Type> m_items;
+    size_t m_first;
+    size_t m_size;
+};
+
+class TimeSeriesRollingWindow
+{
+public:
+    TimeSeriesRollingWindow(time_s64 window, TimeSeriesRolling rolling, int capacity) :
+        m_window(window),
+        m_rolling(rolling),
+        m_sum(0.0),
+        m_samples(rolling == TimeSeriesRolling::Sum || rolling == TimeSeriesRolling::Mean ? capacity : 1),
+        m_extrema(rolling == TimeSeriesRolling::Min || rolling == TimeSeriesRolling::Max ? capacity : 1)
+    {
+    }
+
+    template <class Sink>
+    void push(time_s64 time, value_double value, Sink& sink)
+    {
+        const time_s64 minTime = time - m_window;
+
+        while (!m_samples.empty() && m_samples.front().first <= minTime)
+        {
+            m_sum -= m_samples.front().second;
+            m_samples.pop_front();
+        }
+        while (!m_extrema.empty() && m_extrema.front().first <= minTime)
+        {
+            m_extrema.pop_front();
+        }
+
+        switch (m_rolling)
+        {
+        case TimeSeriesRolling::Min:
+            while (!m_extrema.empty() && m_extrema.back().second >= value)
+            {
+                m_extrema.pop_back();
+            }
+            m_extrema.push_back(std::make_pair(time, value));
+            sink(time, m_extrema.front().second);
+            break;
+        case TimeSeriesRolling::Max:
+            while (!m_extrema.empty() && m_extrema.back().second <= value)
+            {
+                m_extrema.pop_back();
+            }
+            m_extrema.push_back(std::make_pair(time, value));
+            sink(time, m_extrema.front().second);
+            break;
+        case TimeSeriesRolling::Sum:
+        case TimeSeriesRolling::Mean:
+            m_samples.push_back(std::make_pair(time, value));
+            m_sum += value;
+            sink(time, m_rolling == TimeSeriesRolling::Sum ? m_sum : m_sum / m_samples.size());
+            break;
+        }
+    }
+
+private:
+    time_s64 m_window;
+    TimeSeriesRolling m_rolling;
+    value_double m_sum;
+    TimeSeriesRingBuffer<std::pair<time_s64, value_double>> m_samples;
+    TimeSeriesRingBuffer<std::pair<time_s64, value_double>> m_extrema;
+};
+
+template <class Operator>
+struct TimeSeriesIsPipelineStage : std::false_type
+{
+};
+
+template <>
+struct TimeSeriesIsPipelineStage<TimeSeriesRate> : std::true_type
+{
+};
+
+template <>
+struct TimeSeriesIsPipelineStage<TimeSeriesEwma> : std::true_type
+{
+};
+
+template <>
+struct TimeSeriesIsPipelineStage<TimeSeriesRollingWindow> : std::true_type
+{
+};
+
+inline TimeSeriesRate rate(std::chrono::duration<value_double> period = std::chrono::seconds(1))
+{
+    return TimeSeriesRate(period, true);
+}
+
+inline TimeSeriesRate derivative(std::chrono::duration<value_double> period = std::chrono::seconds(1))
+{
+    return TimeSeriesRate(period, false);
+}
+
+inline TimeSeriesEwma ewma(value_double alpha)
+{
+    return TimeSeriesEwma(alpha);
+}
+
+inline TimeSeriesRollingWindow rolling(time_s64 window, TimeSeriesRolling rolling, int capacity = 256)
+{
+    return TimeSeriesRollingWindow(window, rolling, capacity);
+}
+
+template <class Operator>
+inline void setTimeUnit(Operator&, TimeSeriesTimeUnit)
+{
+}
+
+inline void setTimeUnit(TimeSeriesRate& rate, TimeSeriesTimeUnit timeUnit)
+{
+    rate.setTimeUnit(timeUnit);
+}
+
+template <class Source, class Operator>
+class TimeSeriesPipeline
+{
+public:
+    TimeSeriesPipeline(const Source& source, const Operator& op) :
+        m_source(source),
+        m_operator(op)
+    {
+        setTimeUnit(m_operator, m_source.timeUnit());
+    }
+
+    TimeSeriesTimeUnit timeUnit() const
+    {
+        return m_source.timeUnit();
+    }
+
+    template <class Function>
+    void forEach(Function&& function) const
+    {
+        Stage<Function> stage(m_operator, function);
+        m_source.forEach(stage);
+    }
+
+private:
+    template <class Function>
+    class Stage
+    {
+    public:
+        Stage(const Operator& op, Function& function) :
+            m_operator(op),
+            m_function(function)
+        {
+        }
+
+        void operator()(time_s64 time, value_double value)
+        {
+            m_operator.push(time, value, m_function);
+        }
+
+    private:
+        Operator m_operator;
+        Function& m_function;
+    };
+
+    Source m_source;
+    Operator m_operator;
+};
+
+template <int BlockSize, bool Compress, class Operator>
+typename std::enable_if<TimeSeriesIsPipelineStage<Operator>::value,
+                        TimeSeriesPipeline<TimeSeriesDataRange<BlockSize, Compress>, Operator>>::type
+operator|(const TimeSeriesDataRange<BlockSize, Compress>& range, const Operator& op)
+{
+    return TimeSeriesPipeline<TimeSeriesDataRange<BlockSize, Compress>, Operator>(range, op);
+}
+
+template <class Source, class Operator, class NextOperator>
+typename std::enable_if<TimeSeriesIsPipelineStage<NextOperator>::value,
+                        TimeSeriesPipeline<TimeSeriesPipeline<Source, Operator>, NextOperator>>::type
+operator|(const TimeSeriesPipeline<Source, Operator>& pipeline, const NextOperator& op)
+{
+    return TimeSeriesPipeline<TimeSeriesPipeline<Source, Operator>, NextOperator>(pipeline, op);
+}
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_PIPELINE_H
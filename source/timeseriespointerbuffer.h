@@ -23,6 +23,10 @@
 #ifndef TIME_SERIES_POINTER_BUFFER_H
 #define TIME_SERIES_POINTER_BUFFER_H
 
+#include <cstring>
+
+#include "timeseriestrace.h"
+
 namespace TimeSeries {
 
 template <class PointerType>
@@ -72,32 +76,64 @@ public:
     {
         if (m_size == m_allocationSize)
         {
-            m_allocationSize <<= 1;
-            auto newPointerBuffer = new PointerType*[m_allocationSize];
-
-            const int itemCountHead = (m_offset + m_size) & m_allocationSizeMask;
-            const int itemCountTail = m_size - itemCountHead;
-            std::memcpy(newPointerBuffer, m_pointerBuffer + m_offset, sizeof(PointerType*) * itemCountTail);
-            std::memcpy(newPointerBuffer + itemCountTail, m_pointerBuffer, sizeof(PointerType*) * itemCountHead);
-
-            delete[] m_pointerBuffer;
-            m_pointerBuffer = newPointerBuffer;
-            m_allocationSizeMask = m_allocationSize - 1;
-            m_offset = 0;
+            grow();
         }
 
         m_pointerBuffer[(m_offset + m_size) & m_allocationSizeMask] = pPointer;
         m_size++;
     }
 
+    void prepend(PointerType *pPointer)
+    {
+        if (m_size == m_allocationSize)
+        {
+            grow();
+        }
+
+        m_offset = (m_offset - 1) & m_allocationSizeMask;
+        m_pointerBuffer[m_offset] = pPointer;
+        m_size++;
+    }
+
     void removeFirst()
     {
-        delete m_pointerBuffer[m_offset];
+        delete takeFirst();
+    }
+
+    PointerType* replace(int index, PointerType* pPointer)
+    {
+        PointerType*& pSlot = m_pointerBuffer[(m_offset + index) & m_allocationSizeMask];
+        PointerType* pPrevious = pSlot;
+        pSlot = pPointer;
+        return pPrevious;
+    }
+
+    PointerType* takeFirst()
+    {
+        PointerType* pPointer = m_pointerBuffer[m_offset];
         m_offset = (m_offset + 1) & m_allocationSizeMask;
         m_size--;
+        return pPointer;
     }
 
 private:
+    void grow()
+    {
+        TIME_SERIES_TRACE_SCOPE("pointerbuffer.grow", m_allocationSize << 1);
+        m_allocationSize <<= 1;
+        auto newPointerBuffer = new PointerType*[m_allocationSize];
+
+        const int itemCountHead = (m_offset + m_size) & m_allocationSizeMask;
+        const int itemCountTail = m_size - itemCountHead;
+        std::memcpy(newPointerBuffer, m_pointerBuffer + m_offset, sizeof(PointerType*) * itemCountTail);
+        std::memcpy(newPointerBuffer + itemCountTail, m_pointerBuffer, sizeof(PointerType*) * itemCountHead);
+
+        delete[] m_pointerBuffer;
+        m_pointerBuffer = newPointerBuffer;
+        m_allocationSizeMask = m_allocationSize - 1;
+        m_offset = 0;
+    }
+
     int m_size;
     int m_offset;
     int m_allocationSize;
@@ -0,0 +1,262 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_PREFETCH_ITERATOR_H
+#define TIME_SERIES_PREFETCH_ITERATOR_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "timeseriesarraytypes.h"
+#include "timeseriesblockdecoder.h"
+#include "timeseriesdatablock.h"
+#include "timeseriesdatacontainer.h"
+
+namespace TimeSeries {
+
+template <int BlockSize, bool Compress>
+class TimeSeriesPrefetchIterator
+{
+public:
+    TimeSeriesPrefetchIterator(const TimeSeriesDataContainer<BlockSize, Compress>* container,
+                               time_s64 beginTime = 0,
+                               time_s64 endTime = -1,
+                               bool useHelperThread = false) :
+        m_beginTime(beginTime),
+        m_endTime(endTime),
+        m_index(0),
+        m_endIndex(0),
+        m_times(nullptr),
+        m_values(nullptr),
+        m_blockIndex(0),
+        m_blockCount(container->blockCount()),
+        m_state(new State(container)),
+        m_container(container)
+    {
+        if (m_blockCount == 0 || m_container->blockInfo(m_blockCount - 1).endTime < m_beginTime)
+        {
+            m_container = nullptr;
+            return;
+        }
+
+        const int blockIndex = m_container->findBlock(m_beginTime);
+        if (useHelperThread && blockIndex + 1 < m_blockCount)
+        {
+            m_state->thread = std::thread(&State::run, m_state.get());
+        }
+
+        loadBlock(blockIndex);
+        m_index = static_cast<int>(std::upper_bound(m_times, m_times + m_endIndex, m_beginTime) - m_times);
+        m_index = std::max(m_index - 1, 0);
+    }
+
+    TimeSeriesPrefetchIterator(TimeSeriesPrefetchIterator&&) = default;
+
+    time_s64 time() const
+    {
+        return m_times[m_index];
+    }
+
+    value_double value() const
+    {
+        return reinterpret_cast<const value_double*>(m_values)[m_index];
+    }
+
+    bool isValid() const
+    {
+        return m_container != nullptr;
+    }
+
+    void next()
+    {
+        if (++m_index >= m_endIndex)
+        {
+            nextBlock();
+        }
+    }
+
+    int count() const
+    {
+        return m_endIndex - m_index;
+    }
+
+    const time_s64* times() const
+    {
+        return m_times + m_index;
+    }
+
+    const value_double* values() const
+    {
+        return reinterpret_cast<const value_double*>(m_values) + m_index;
+    }
+
+    void nextBlock()
+    {
+        if (m_blockIndex + 1 >= m_blockCount)
+        {
+            m_container = nullptr;
+        }
+        else
+        {
+            loadBlock(m_blockIndex + 1);
+        }
+    }
+
+private:
+    struct State
+    {
+        State(const TimeSeriesDataContainer<BlockSize, Compress>* container) :
+            slot(0),
+            requestIndex(-1),
+            readyIndex(-1),
+            readyCount(0),
+            isStopped(false),
+            container(container)
+        {
+        }
+
+        ~State()
+        {
+            if (thread.joinable())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    isStopped = true;
+                }
+                condition.notify_all();
+                thread.join();
+            }
+        }
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            while (true)
+            {
+                condition.wait(lock, [this] { return isStopped || requestIndex > readyIndex; });
+                if (isStopped)
+                {
+                    return;
+                }
+
+                const int blockIndex = requestIndex;
+                TimeSeriesBlockDecoder<BlockSize, Compress>& decoder = decoders[slot ^ 1];
+                lock.unlock();
+
+                const int count = decoder.decode(container->block(blockIndex));
+
+                lock.lock();
+                readyIndex = blockIndex;
+                readyCount = count;
+                condition.notify_all();
+            }
+        }
+
+        int decode(int blockIndex)
+        {
+            if (thread.joinable())
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (requestIndex == blockIndex)
+                {
+                    condition.wait(lock, [this, blockIndex] { return readyIndex == blockIndex; });
+                    slot ^= 1;
+                    return readyCount;
+                }
+            }
+
+            return decoders[slot].decode(container->block(blockIndex));
+        }
+
+        void request(int blockIndex)
+        {
+            if (thread.joinable())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    requestIndex = blockIndex;
+                }
+                condition.notify_all();
+            }
+            else
+            {
+                container->block(blockIndex)->prefetch();
+            }
+        }
+
+        TimeSeriesBlockDecoder<BlockSize, Compress> decoders[2];
+        int slot;
+        int requestIndex;
+        int readyIndex;
+        int readyCount;
+        bool isStopped;
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::thread thread;
+        const TimeSeriesDataContainer<BlockSize, Compress>* container;
+    };
+
+    void loadBlock(int blockIndex)
+    {
+        m_blockIndex = blockIndex;
+        m_endIndex = m_state->decode(blockIndex);
+        m_times = m_state->decoders[m_state->slot].times();
+        m_values = reinterpret_cast<const value_u64*>(m_state->decoders[m_state->slot].values());
+        m_index = 0;
+
+        if (m_endTime >= 0)
+        {
+            const int endIndex = static_cast<int>(std::lower_bound(m_times, m_times + m_endIndex, m_endTime) - m_times);
+            if (endIndex < m_endIndex)
+            {
+                m_endIndex = endIndex + 1;
+                m_blockCount = blockIndex + 1;
+            }
+        }
+
+        if (blockIndex + 1 < m_blockCount)
+        {
+            m_state->request(blockIndex + 1);
+        }
+    }
+
+    time_s64 m_beginTime;
+    time_s64 m_endTime;
+
+    int m_index;
+    int m_endIndex;
+    const time_s64* m_times;
+    const value_u64* m_values;
+
+    int m_blockIndex;
+    int m_blockCount;
+    std::unique_ptr<State> m_state;
+    const TimeSeriesDataContainer<BlockSize, Compress>* m_container;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_PREFETCH_ITERATOR_H
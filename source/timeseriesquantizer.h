@@ -0,0 +1,153 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef TIME_SERIES_QUANTIZER_H
+#define TIME_SERIES_QUANTIZER_H
+
+#include <cmath>
+#include <cstring>
+
+#include "timeseriesarraytypes.h"
+
+namespace TimeSeries {
+
+enum class TimeSeriesErrorBound
+{
+    None,
+    Absolute,
+    Relative
+};
+
+class TimeSeriesQuantizer
+{
+public:
+    TimeSeriesQuantizer() :
+        m_errorBound(TimeSeriesErrorBound::None),
+        m_bound(0.0),
+        m_step(0.0),
+        m_roundBit(0),
+        m_mantissaMask(~0ULL),
+        m_maxAbsoluteError(0.0),
+        m_maxRelativeError(0.0)
+    {
+    }
+
+    void setErrorBound(TimeSeriesErrorBound errorBound, value_double bound)
+    {
+        m_errorBound = bound > 0.0 ? errorBound : TimeSeriesErrorBound::None;
+        m_bound = bound;
+        m_step = 0.0;
+        m_roundBit = 0;
+        m_mantissaMask = ~0ULL;
+
+        if (m_errorBound == TimeSeriesErrorBound::Absolute)
+        {
+            int exponent = 0;
+            std::frexp(2.0 * bound, &exponent);
+            m_step = std::ldexp(1.0, exponent - 1);
+        }
+        else if (m_errorBound == TimeSeriesErrorBound::Relative)
+        {
+            int keepBits = static_cast<int>(std::ceil(-std::log2(bound))) - 1;
+            keepBits = keepBits < 0 ? 0 : (keepBits > 52 ? 52 : keepBits);
+
+            const int dropBits = 52 - keepBits;
+            if (dropBits > 0)
+            {
+                m_roundBit = 1ULL << (dropBits - 1);
+                m_mantissaMask = ~((1ULL << dropBits) - 1);
+            }
+        }
+    }
+
+    TimeSeriesErrorBound errorBound() const
+    {
+        return m_errorBound;
+    }
+
+    value_double bound() const
+    {
+        return m_bound;
+    }
+
+    value_double maxAbsoluteError() const
+    {
+        return m_maxAbsoluteError;
+    }
+
+    value_double maxRelativeError() const
+    {
+        return m_maxRelativeError;
+    }
+
+    value_double quantize(value_double value)
+    {
+        if (m_errorBound == TimeSeriesErrorBound::None || !std::isfinite(value))
+        {
+            return value;
+        }
+
+        value_double quantized = value;
+
+        if (m_errorBound == TimeSeriesErrorBound::Absolute)
+        {
+            quantized = std::round(value / m_step) * m_step;
+        }
+        else if (std::fpclassify(value) == FP_NORMAL)
+        {
+            value_u64 bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            bits = (bits + m_roundBit) & m_mantissaMask;
+            std::memcpy(&quantized, &bits, sizeof(bits));
+        }
+
+        if (!std::isfinite(quantized))
+        {
+            return value;
+        }
+
+        const value_double absoluteError = std::fabs(quantized - value);
+        m_maxAbsoluteError = absoluteError > m_maxAbsoluteError ? absoluteError : m_maxAbsoluteError;
+
+        if (value != 0.0)
+        {
+            const value_double relativeError = absoluteError / std::fabs(value);
+            m_maxRelativeError = relativeError > m_maxRelativeError ? relativeError : m_maxRelativeError;
+        }
+
+        return quantized;
+    }
+
+private:
+    TimeSeriesErrorBound m_errorBound;
+    value_double m_bound;
+    value_double m_step;
+    value_u64 m_roundBit;
+    value_u64 m_mantissaMask;
+    value_double m_maxAbsoluteError;
+    value_double m_maxRelativeError;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_QUANTIZER_H
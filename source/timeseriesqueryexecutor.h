@@ -0,0 +1,312 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_QUERY_EXECUTOR_H
+#define TIME_SERIES_QUERY_EXECUTOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "timeseriesaggregate.h"
+#include "timeseriesarray.h"
+#include "timeseriesarraytypes.h"
+
+namespace TimeSeries {
+
+enum class TimeSeriesQueryPriority
+{
+    Interactive,
+    Batch
+};
+
+enum class TimeSeriesQueryStatus
+{
+    Completed,
+    Cancelled,
+    DeadlineExceeded,
+    Rejected
+};
+
+struct TimeSeriesQueryStats
+{
+    TimeSeriesQueryStats() :
+        status(TimeSeriesQueryStatus::Completed),
+        queueTime(0.0),
+        runTime(0.0),
+        blockCount(0),
+        sampleCount(0)
+    {
+    }
+
+    TimeSeriesQueryStatus status;
+    double queueTime;
+    double runTime;
+    int blockCount;
+    size_t sampleCount;
+};
+
+template <class Value>
+struct TimeSeriesQueryResult
+{
+    Value value;
+    TimeSeriesQueryStats stats;
+};
+
+class TimeSeriesCancellation
+{
+public:
+    TimeSeriesCancellation() :
+        m_isCancelled(std::make_shared<std::atomic<bool>>(false))
+    {
+    }
+
+    void cancel()
+    {
+        m_isCancelled->store(true, std::memory_order_relaxed);
+    }
+
+    bool isCancelled() const
+    {
+        return m_isCancelled->load(std::memory_order_relaxed);
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_isCancelled;
+};
+
+struct TimeSeriesQueryOptions
+{
+    TimeSeriesQueryOptions(TimeSeriesQueryPriority priority = TimeSeriesQueryPriority::Interactive,
+                           time_s64 timeoutMillis = -1,
+                           const TimeSeriesCancellation& cancellation = TimeSeriesCancellation()) :
+        priority(priority),
+        timeoutMillis(timeoutMillis),
+        cancellation(cancellation)
+    {
+    }
+
+    TimeSeriesQueryPriority priority;
+    time_s64 timeoutMillis;
+    TimeSeriesCancellation cancellation;
+};
+
+template <int BlockSize = 8192, bool Compress = true>
+class TimeSeriesQueryExecutor
+{
+public:
+    typedef TimeSeriesArray<BlockSize, Compress> Array;
+    typedef std::vector<std::pair<time_s64, value_double>> Samples;
+
+    TimeSeriesQueryExecutor(int threadCount, int interactiveThreadCount = 1, size_t queueCapacity = 1024) :
+        m_queueCapacity(queueCapacity),
+        m_isStopped(false)
+    {
+        threadCount = threadCount > 1 ? threadCount : 2;
+        interactiveThreadCount = std::max(1, std::min(interactiveThreadCount, threadCount - 1));
+
+        for (int index = 0; index < threadCount; ++index)
+        {
+            m_threads.emplace_back(&TimeSeriesQueryExecutor::run, this, index < interactiveThreadCount);
+        }
+    }
+
+    TimeSeriesQueryExecutor(const TimeSeriesQueryExecutor&) = delete;
+    TimeSeriesQueryExecutor& operator=(const TimeSeriesQueryExecutor&) = delete;
+
+    ~TimeSeriesQueryExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_isStopped = true;
+        }
+        m_condition.notify_all();
+
+        for (auto& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    size_t queuedCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_interactiveTasks.size() + m_batchTasks.size();
+    }
+
+    std::future<TimeSeriesQueryResult<Samples>> range(Array& array, time_s64 beginTime, time_s64 endTime,
+                                                       const TimeSeriesQueryOptions& options = TimeSeriesQueryOptions())
+    {
+        return submit<Samples>(array, beginTime, endTime, options,
+                               [](time_s64 time, value_double value, Samples& samples) {
+                                   samples.push_back(std::make_pair(time, value));
+                               });
+    }
+
+    std::future<TimeSeriesQueryResult<TimeSeriesAggregate>> aggregate(Array& array, time_s64 beginTime,
+                                                                       time_s64 endTime,
+                                                                       const TimeSeriesQueryOptions& options =
+                                                                           TimeSeriesQueryOptions())
+    {
+        const time_s64 lastTime = endTime < 0 ? std::numeric_limits<time_s64>::max() : endTime;
+        return submit<TimeSeriesAggregate>(array, beginTime, endTime, options,
+                                           [beginTime, lastTime](time_s64 time, value_double value,
+                                                                 TimeSeriesAggregate& aggregate) {
+                                               if (time >= beginTime && time <= lastTime)
+                                               {
+                                                   aggregate.add(value);
+                                               }
+                                           });
+    }
+
+    template <class Value, class Function>
+    std::future<TimeSeriesQueryResult<Value>> submit(Array& array, time_s64 beginTime, time_s64 endTime,
+                                                     const TimeSeriesQueryOptions& options, Function function)
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        const auto promise = std::make_shared<std::promise<TimeSeriesQueryResult<Value>>>();
+        auto future = promise->get_future();
+
+        const auto submitTime = Clock::now();
+        const auto deadline = options.timeoutMillis < 0 ? Clock::time_point::max()
+                                                        : submitTime + std::chrono::milliseconds(options.timeoutMillis);
+        const TimeSeriesCancellation cancellation = options.cancellation;
+
+        std::function<void()> task = [this, promise, &array, beginTime, endTime, cancellation, deadline,
+                                      submitTime, function]() mutable {
+            TimeSeriesQueryResult<Value> result;
+            const auto startTime = Clock::now();
+            result.stats.queueTime = std::chrono::duration<double>(startTime - submitTime).count();
+
+            const auto proceed = [&]() {
+                if (m_isStopped.load(std::memory_order_relaxed) || cancellation.isCancelled())
+                {
+                    result.stats.status = TimeSeriesQueryStatus::Cancelled;
+                    return false;
+                }
+                if (deadline != Clock::time_point::max() && Clock::now() >= deadline)
+                {
+                    result.stats.status = TimeSeriesQueryStatus::DeadlineExceeded;
+                    return false;
+                }
+                return true;
+            };
+
+            if (proceed())
+            {
+                const auto snapshot = array.snapshot();
+                result.stats.blockCount = snapshot.forEach(beginTime, endTime,
+                                                           [&](time_s64 time, value_double value) {
+                                                               function(time, value, result.value);
+                                                               ++result.stats.sampleCount;
+                                                           },
+                                                           proceed);
+            }
+
+            result.stats.runTime = std::chrono::duration<double>(Clock::now() - startTime).count();
+            promise->set_value(std::move(result));
+        };
+
+        if (!enqueue(options.priority, std::move(task)))
+        {
+            TimeSeriesQueryResult<Value> result;
+            result.stats.status = TimeSeriesQueryStatus::Rejected;
+            promise->set_value(std::move(result));
+        }
+
+        return future;
+    }
+
+private:
+    bool enqueue(TimeSeriesQueryPriority priority, std::function<void()>&& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_isStopped || m_interactiveTasks.size() + m_batchTasks.size() >= m_queueCapacity)
+            {
+                return false;
+            }
+
+            if (priority == TimeSeriesQueryPriority::Interactive)
+            {
+                m_interactiveTasks.push_back(std::move(task));
+            }
+            else
+            {
+                m_batchTasks.push_back(std::move(task));
+            }
+        }
+
+        m_condition.notify_all();
+        return true;
+    }
+
+    void run(bool isInteractiveOnly)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while (true)
+        {
+            m_condition.wait(lock, [&] {
+                return m_isStopped || !m_interactiveTasks.empty() || (!isInteractiveOnly && !m_batchTasks.empty());
+            });
+
+            std::deque<std::function<void()>>* tasks = !m_interactiveTasks.empty() ? &m_interactiveTasks
+                                                      : !isInteractiveOnly && !m_batchTasks.empty() ? &m_batchTasks
+                                                      : nullptr;
+            if (!tasks)
+            {
+                return;
+            }
+
+            std::function<void()> task = std::move(tasks->front());
+            tasks->pop_front();
+
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    size_t m_queueCapacity;
+    std::atomic<bool> m_isStopped;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::function<void()>> m_interactiveTasks;
+    std::deque<std::function<void()>> m_batchTasks;
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_QUERY_EXECUTOR_H
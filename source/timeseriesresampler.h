@@ -0,0 +1,329 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_RESAMPLER_H
+#define TIME_SERIES_RESAMPLER_H
+
+#include <algorithm>
+#include <limits>
+
+#include "timeseriesarraytypes.h"
+#include "timeseriesblockdecoder.h"
+#include "timeseriesblockdirectory.h"
+#include "timeseriesdatacontainer.h"
+
+namespace TimeSeries {
+
+enum class TimeSeriesFill
+{
+    None,
+    Previous,
+    Linear
+};
+
+enum class TimeSeriesCellAggregate
+{
+    Mean,
+    Min,
+    Max,
+    Sum,
+    First,
+    Last
+};
+
+template <int BlockSize, bool Compress>
+class TimeSeriesResampler
+{
+public:
+    TimeSeriesResampler(const TimeSeriesDataContainer<BlockSize, Compress>* container) :
+        m_beginTime(0),
+        m_step(1),
+        m_cellCount(0),
+        m_filledCount(0),
+        m_fill(TimeSeriesFill::None),
+        m_aggregate(TimeSeriesCellAggregate::Mean),
+        m_out(nullptr),
+        m_container(container)
+    {
+    }
+
+    ~TimeSeriesResampler() = default;
+
+    size_t resample(time_s64 beginTime, time_s64 endTime, time_s64 step,
+                    TimeSeriesFill fill, TimeSeriesCellAggregate aggregate, value_double* out)
+    {
+        if (step <= 0 || endTime <= beginTime)
+        {
+            return 0;
+        }
+
+        m_beginTime = beginTime;
+        m_step = step;
+        m_cellCount = static_cast<size_t>((endTime - beginTime + step - 1) / step);
+        m_fill = fill;
+        m_aggregate = aggregate;
+        m_out = out;
+        m_cell = Cell();
+        m_previous = Sample();
+        m_filledCount = 0;
+
+        std::fill(out, out + m_cellCount, std::numeric_limits<value_double>::quiet_NaN());
+
+        const time_s64 gridEnd = beginTime + static_cast<time_s64>(m_cellCount) * step;
+        Sample next;
+
+        for (int blockIndex = m_container->findBlock(beginTime);
+             blockIndex < m_container->blockCount() && !next.isValid;
+             ++blockIndex)
+        {
+            const TimeSeriesBlockInfo info = m_container->blockInfo(blockIndex);
+
+            if (blockIndex + 1 < m_container->blockCount() && info.beginTime >= beginTime &&
+                info.endTime < gridEnd && cellOf(info.beginTime) == cellOf(info.endTime))
+            {
+                addSummary(info);
+                continue;
+            }
+
+            const int count = m_decoder.decode(m_container, blockIndex);
+            const time_s64* times = m_decoder.times();
+            const value_double* values = m_decoder.values();
+
+            int index = static_cast<int>(std::lower_bound(times, times + count, beginTime) - times);
+            if (index > 0)
+            {
+                m_previous = Sample(times[index - 1], values[index - 1]);
+            }
+
+            while (index < count)
+            {
+                if (times[index] >= gridEnd)
+                {
+                    next = Sample(times[index], values[index]);
+                    break;
+                }
+
+                const size_t cell = cellOf(times[index]);
+                const time_s64 cellEnd = std::min(gridEnd, m_beginTime + static_cast<time_s64>(cell + 1) * m_step);
+                const int endIndex = static_cast<int>(std::lower_bound(times + index, times + count, cellEnd) - times);
+
+                addSpan(cell, times, values, index, endIndex);
+                index = endIndex;
+            }
+        }
+
+        flushCell();
+        fillCells(m_cellCount, next);
+        return m_cellCount;
+    }
+
+private:
+    struct Sample
+    {
+        Sample() :
+            time(0),
+            value(0.0),
+            isValid(false)
+        {
+        }
+
+        Sample(time_s64 time, value_double value) :
+            time(time),
+            value(value),
+            isValid(true)
+        {
+        }
+
+        time_s64 time;
+        value_double value;
+        bool isValid;
+    };
+
+    struct Cell
+    {
+        Cell() :
+            index(0),
+            count(0),
+            sum(0.0),
+            min(0.0),
+            max(0.0),
+            first(0.0),
+            last(0.0),
+            lastTime(0)
+        {
+        }
+
+        size_t index;
+        size_t count;
+        value_double sum;
+        value_double min;
+        value_double max;
+        value_double first;
+        value_double last;
+        time_s64 lastTime;
+    };
+
+    size_t cellOf(time_s64 time) const
+    {
+        return static_cast<size_t>((time - m_beginTime) / m_step);
+    }
+
+    void addSummary(const TimeSeriesBlockInfo& info)
+    {
+        const value_double beginValue = bitCast<value_double>(info.beginValue);
+        const value_double endValue = bitCast<value_double>(info.endValue);
+
+        beginCell(cellOf(info.beginTime), Sample(info.beginTime, beginValue));
+        m_cell.count += info.count;
+        m_cell.sum += info.sum;
+        m_cell.min = std::min(m_cell.min, info.minValue);
+        m_cell.max = std::max(m_cell.max, info.maxValue);
+        m_cell.last = endValue;
+        m_cell.lastTime = info.endTime;
+    }
+
+    void addSpan(size_t cell, const time_s64* times, const value_double* values, int beginIndex, int endIndex)
+    {
+        beginCell(cell, Sample(times[beginIndex], values[beginIndex]));
+
+        value_double sum = 0.0;
+        value_double min = m_cell.min;
+        value_double max = m_cell.max;
+        for (int index = beginIndex; index < endIndex; ++index)
+        {
+            sum += values[index];
+            min = values[index] < min ? values[index] : min;
+            max = values[index] > max ? values[index] : max;
+        }
+
+        m_cell.count += endIndex - beginIndex;
+        m_cell.sum += sum;
+        m_cell.min = min;
+        m_cell.max = max;
+        m_cell.last = values[endIndex - 1];
+        m_cell.lastTime = times[endIndex - 1];
+    }
+
+    void beginCell(size_t cell, const Sample& first)
+    {
+        if (m_cell.count > 0 && m_cell.index == cell)
+        {
+            return;
+        }
+
+        flushCell();
+        fillCells(cell, first);
+
+        m_cell = Cell();
+        m_cell.index = cell;
+        m_cell.min = std::numeric_limits<value_double>::infinity();
+        m_cell.max = -std::numeric_limits<value_double>::infinity();
+        m_cell.first = first.value;
+    }
+
+    void flushCell()
+    {
+        if (m_cell.count == 0)
+        {
+            return;
+        }
+
+        value_double value = 0.0;
+        switch (m_aggregate)
+        {
+        case TimeSeriesCellAggregate::Mean:
+            value = m_cell.sum / m_cell.count;
+            break;
+        case TimeSeriesCellAggregate::Min:
+            value = m_cell.min;
+            break;
+        case TimeSeriesCellAggregate::Max:
+            value = m_cell.max;
+            break;
+        case TimeSeriesCellAggregate::Sum:
+            value = m_cell.sum;
+            break;
+        case TimeSeriesCellAggregate::First:
+            value = m_cell.first;
+            break;
+        case TimeSeriesCellAggregate::Last:
+            value = m_cell.last;
+            break;
+        }
+
+        m_out[m_cell.index] = value;
+        m_filledCount = m_cell.index + 1;
+        m_previous = Sample(m_cell.lastTime, m_cell.last);
+        m_cell.count = 0;
+    }
+
+    void fillCells(size_t endCell, const Sample& next)
+    {
+        const size_t beginCell = m_filledCount;
+        m_filledCount = std::max(m_filledCount, endCell);
+
+        if (beginCell >= endCell || !m_previous.isValid || m_fill == TimeSeriesFill::None)
+        {
+            return;
+        }
+
+        value_double* out = m_out;
+        if (m_fill == TimeSeriesFill::Previous || !next.isValid)
+        {
+            const value_double value = m_previous.value;
+            for (size_t cell = beginCell; cell < endCell; ++cell)
+            {
+                out[cell] = value;
+            }
+            return;
+        }
+
+        const value_double slope = (next.value - m_previous.value) / static_cast<value_double>(next.time - m_previous.time);
+        const value_double base = m_previous.value +
+                                  static_cast<value_double>(m_beginTime + static_cast<time_s64>(beginCell) * m_step -
+                                                            m_previous.time) * slope;
+        const value_double delta = static_cast<value_double>(m_step) * slope;
+        const size_t count = endCell - beginCell;
+        out += beginCell;
+
+        for (size_t index = 0; index < count; ++index)
+        {
+            out[index] = base + static_cast<value_double>(index) * delta;
+        }
+    }
+
+    time_s64 m_beginTime;
+    time_s64 m_step;
+    size_t m_cellCount;
+    size_t m_filledCount;
+    TimeSeriesFill m_fill;
+    TimeSeriesCellAggregate m_aggregate;
+    value_double* m_out;
+    Cell m_cell;
+    Sample m_previous;
+    TimeSeriesBlockDecoder<BlockSize, Compress> m_decoder;
+    const TimeSeriesDataContainer<BlockSize, Compress>* m_container;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_RESAMPLER_H
@@ -0,0 +1,244 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_SHARDED_INGEST_H
+#define TIME_SERIES_SHARDED_INGEST_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "timeseriesarray.h"
+#include "timeseriesarraytypes.h"
+#include "timeseriesmpscqueue.h"
+
+namespace TimeSeries {
+
+template <int BlockSize = 8192, bool Compress = true>
+class TimeSeriesShardedIngest
+{
+public:
+    typedef TimeSeriesArray<BlockSize, Compress> Array;
+
+    TimeSeriesShardedIngest(int shardCount, time_s64 sizeMillis, int queueCapacity = 1 << 16,
+                            int batchSize = 1024) :
+        m_sizeMillis(sizeMillis),
+        m_batchSize(batchSize > 0 ? batchSize : 1)
+    {
+        for (int index = 0; index < (shardCount > 0 ? shardCount : 1); ++index)
+        {
+            m_shards.emplace_back(new Shard(queueCapacity));
+        }
+
+        for (auto& shard : m_shards)
+        {
+            shard->thread = std::thread(&TimeSeriesShardedIngest::run, this, shard.get());
+        }
+    }
+
+    TimeSeriesShardedIngest(const TimeSeriesShardedIngest&) = delete;
+    TimeSeriesShardedIngest& operator=(const TimeSeriesShardedIngest&) = delete;
+
+    ~TimeSeriesShardedIngest()
+    {
+        for (auto& shard : m_shards)
+        {
+            {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                shard->isRunning = false;
+            }
+            shard->condition.notify_one();
+            shard->thread.join();
+        }
+    }
+
+    int shardCount() const
+    {
+        return static_cast<int>(m_shards.size());
+    }
+
+    int shardOf(value_u64 seriesId) const
+    {
+        value_u64 hash = seriesId * 0x9E3779B97F4A7C15ULL;
+        hash ^= hash >> 32;
+        return static_cast<int>(hash % m_shards.size());
+    }
+
+    void append(value_u64 seriesId, time_s64 time, value_double value)
+    {
+        Shard* shard = m_shards[shardOf(seriesId)].get();
+        const Record record = { seriesId, time, value };
+
+        while (!shard->queue.push(record))
+        {
+            wake(shard);
+            std::this_thread::yield();
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (shard->isSleeping.load(std::memory_order_relaxed))
+        {
+            wake(shard);
+        }
+    }
+
+    void flush()
+    {
+        for (auto& shard : m_shards)
+        {
+            const size_t pushCount = shard->queue.pushCount();
+            while (shard->appliedCount.load(std::memory_order_acquire) < pushCount)
+            {
+                wake(shard.get());
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    const Array* series(value_u64 seriesId) const
+    {
+        Shard* shard = m_shards[shardOf(seriesId)].get();
+        std::lock_guard<std::mutex> lock(shard->mutex);
+
+        const auto series = shard->series.find(seriesId);
+        return series != shard->series.end() ? series->second.get() : nullptr;
+    }
+
+    size_t seriesCount() const
+    {
+        size_t count = 0;
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            count += shard->series.size();
+        }
+        return count;
+    }
+
+private:
+    struct Record
+    {
+        value_u64 seriesId;
+        time_s64 time;
+        value_double value;
+    };
+
+    struct Shard
+    {
+        Shard(int queueCapacity) :
+            queue(queueCapacity),
+            appliedCount(0),
+            isSleeping(false),
+            isRunning(true)
+        {
+        }
+
+        TimeSeriesMpscQueue<Record> queue;
+        std::atomic<size_t> appliedCount;
+        std::atomic<bool> isSleeping;
+        bool isRunning;
+        std::unordered_map<value_u64, std::unique_ptr<Array>> series;
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::thread thread;
+    };
+
+    static void wake(Shard* shard)
+    {
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+        }
+        shard->condition.notify_one();
+    }
+
+    void run(Shard* shard)
+    {
+        std::vector<Record> batch(m_batchSize);
+        size_t appliedCount = 0;
+        value_u64 lastSeriesId = 0;
+        Array* lastSeries = nullptr;
+
+        for (;;)
+        {
+            const int count = shard->queue.pop(batch.data(), m_batchSize);
+
+            for (int index = 0; index < count; ++index)
+            {
+                const Record& record = batch[index];
+                if (!lastSeries || record.seriesId != lastSeriesId)
+                {
+                    lastSeries = findOrCreateSeries(shard, record.seriesId);
+                    lastSeriesId = record.seriesId;
+                }
+                lastSeries->append(record.time, record.value);
+            }
+
+            appliedCount += count;
+            shard->appliedCount.store(appliedCount, std::memory_order_release);
+
+            if (count > 0)
+            {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(shard->mutex);
+            if (!shard->isRunning && shard->queue.pushCount() == appliedCount)
+            {
+                break;
+            }
+
+            shard->isSleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (shard->queue.pushCount() == appliedCount)
+            {
+                shard->condition.wait(lock);
+            }
+            shard->isSleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    Array* findOrCreateSeries(Shard* shard, value_u64 seriesId)
+    {
+        const auto series = shard->series.find(seriesId);
+        if (series != shard->series.end())
+        {
+            return series->second.get();
+        }
+
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        Array* array = new Array(m_sizeMillis);
+        shard->series[seriesId].reset(array);
+        return array;
+    }
+
+    time_s64 m_sizeMillis;
+    int m_batchSize;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_SHARDED_INGEST_H
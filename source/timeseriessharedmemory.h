@@ -0,0 +1,461 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_SHARED_MEMORY_H
+#define TIME_SERIES_SHARED_MEMORY_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "timeseriesarraytypes.h"
+#include "timeseriesblockimage.h"
+#include "timeseriesdatablock.h"
+#include "timeseriesdatacontainer.h"
+#include "timeseriesdataiterator.h"
+#include "timeseriesdatarange.h"
+
+namespace TimeSeries {
+
+template <int BlockSize, bool Compress>
+class TimeSeriesSharedMemoryLayout
+{
+public:
+    struct Header
+    {
+        char magic[8];
+        int blockSize;
+        int compress;
+        int slotCount;
+        int slotSize;
+        std::atomic<sequence_s64> firstSequence;
+        std::atomic<sequence_s64> endSequence;
+    };
+
+    struct Slot
+    {
+        std::atomic<value_u64> version;
+        TimeSeriesBlockImage image;
+    };
+
+    static const int HeaderSize = (sizeof(Header) + 63) & ~63;
+    static const int SlotSize = (sizeof(Slot) + TimeSeriesDataBlock<BlockSize, Compress>::PayloadSize + 8 + 63) & ~63;
+
+    static const char* magic()
+    {
+        return "TSSHM001";
+    }
+
+    static size_t mappingSize(int slotCount)
+    {
+        return HeaderSize + static_cast<size_t>(slotCount) * SlotSize;
+    }
+
+    static Slot* slot(void* mapping, int slotCount, sequence_s64 sequence)
+    {
+        return reinterpret_cast<Slot*>(static_cast<value_u8*>(mapping) + HeaderSize +
+                                       static_cast<size_t>((sequence % slotCount + slotCount) % slotCount) * SlotSize);
+    }
+
+    static value_u8* payload(Slot* slot)
+    {
+        return reinterpret_cast<value_u8*>(slot + 1);
+    }
+
+    static const value_u8* payload(const Slot* slot)
+    {
+        return reinterpret_cast<const value_u8*>(slot + 1);
+    }
+};
+
+template <int BlockSize, bool Compress>
+class TimeSeriesSharedMemoryWriter
+{
+public:
+    typedef TimeSeriesSharedMemoryLayout<BlockSize, Compress> Layout;
+
+    TimeSeriesSharedMemoryWriter() :
+        m_slotCount(0),
+        m_mappingSize(0),
+        m_mapping(nullptr),
+        m_header(nullptr),
+        m_publishInterval(1),
+        m_pendingCount(0),
+        m_beginSequence(std::numeric_limits<sequence_s64>::min()),
+        m_publishedSequence(std::numeric_limits<sequence_s64>::min()),
+        m_publishedSize(0)
+    {
+    }
+
+    TimeSeriesSharedMemoryWriter(const TimeSeriesSharedMemoryWriter&) = delete;
+    TimeSeriesSharedMemoryWriter& operator=(const TimeSeriesSharedMemoryWriter&) = delete;
+
+    ~TimeSeriesSharedMemoryWriter()
+    {
+        close();
+    }
+
+    bool create(const char* name, int slotCount, int publishInterval = 1)
+    {
+        close();
+
+        const int fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        const size_t mappingSize = Layout::mappingSize(slotCount);
+        void* mapping = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(mappingSize)) == 0)
+        {
+            mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+
+        if (mapping == MAP_FAILED)
+        {
+            shm_unlink(name);
+            return false;
+        }
+
+        m_name = name;
+        m_slotCount = slotCount;
+        m_mappingSize = mappingSize;
+        m_mapping = mapping;
+        m_publishInterval = publishInterval > 0 ? publishInterval : 1;
+        m_pendingCount = 0;
+        m_beginSequence = std::numeric_limits<sequence_s64>::min();
+        m_publishedSequence = std::numeric_limits<sequence_s64>::min();
+        m_publishedSize = 0;
+
+        for (sequence_s64 sequence = 0; sequence < slotCount; ++sequence)
+        {
+            typename Layout::Slot* slot = Layout::slot(m_mapping, m_slotCount, sequence);
+            new (&slot->version) std::atomic<value_u64>(0);
+            slot->image.sequence = std::numeric_limits<sequence_s64>::min();
+        }
+
+        m_header = new (m_mapping) typename Layout::Header;
+        m_header->blockSize = BlockSize;
+        m_header->compress = Compress;
+        m_header->slotCount = slotCount;
+        m_header->slotSize = Layout::SlotSize;
+        m_header->firstSequence.store(0, std::memory_order_relaxed);
+        m_header->endSequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(m_header->magic, Layout::magic(), sizeof(m_header->magic));
+        return true;
+    }
+
+    void close()
+    {
+        if (!m_mapping)
+        {
+            return;
+        }
+
+        munmap(m_mapping, m_mappingSize);
+        shm_unlink(m_name.c_str());
+        m_mapping = nullptr;
+        m_header = nullptr;
+    }
+
+    bool isOpen() const
+    {
+        return m_mapping != nullptr;
+    }
+
+    void append(const TimeSeriesDataContainer<BlockSize, Compress>& container)
+    {
+        if (++m_pendingCount >= m_publishInterval ||
+            container.blockSequence(container.blockCount() - 1) != m_publishedSequence)
+        {
+            publish(container);
+        }
+    }
+
+    void publish(const TimeSeriesDataContainer<BlockSize, Compress>& container)
+    {
+        m_pendingCount = 0;
+
+        const int blockCount = container.blockCount();
+        if (blockCount == 0)
+        {
+            return;
+        }
+
+        const sequence_s64 firstSequence = container.blockSequence(0);
+        const sequence_s64 lastSequence = container.blockSequence(blockCount - 1);
+        const sequence_s64 beginSequence = std::max(firstSequence, lastSequence - m_slotCount + 1);
+
+        if (m_publishedSequence != std::numeric_limits<sequence_s64>::min())
+        {
+            for (sequence_s64 sequence = beginSequence; sequence < std::min(m_beginSequence, lastSequence); ++sequence)
+            {
+                writeSlot(sequence, container.block(static_cast<int>(sequence - firstSequence)), 0);
+            }
+        }
+
+        m_beginSequence = beginSequence;
+        m_header->firstSequence.store(beginSequence, std::memory_order_release);
+
+        for (sequence_s64 sequence = std::max(beginSequence, m_publishedSequence);
+             sequence <= lastSequence; ++sequence)
+        {
+            const int fromSize = sequence == m_publishedSequence ? m_publishedSize : 0;
+            writeSlot(sequence, container.block(static_cast<int>(sequence - firstSequence)), fromSize);
+        }
+
+        m_publishedSequence = lastSequence;
+        m_publishedSize = container.block(blockCount - 1)->size();
+        m_header->endSequence.store(lastSequence + 1, std::memory_order_release);
+    }
+
+private:
+    void writeSlot(sequence_s64 sequence, const TimeSeriesDataBlock<BlockSize, Compress>* block,
+                   int fromSize)
+    {
+        typename Layout::Slot* slot = Layout::slot(m_mapping, m_slotCount, sequence);
+        const value_u64 version = slot->version.load(std::memory_order_relaxed);
+
+        slot->version.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot->image.sequence = sequence;
+        block->exportImage(slot->image, Layout::payload(slot), fromSize);
+
+        slot->version.store(version + 2, std::memory_order_release);
+    }
+
+    std::string m_name;
+    int m_slotCount;
+    size_t m_mappingSize;
+    void* m_mapping;
+    typename Layout::Header* m_header;
+    int m_publishInterval;
+    int m_pendingCount;
+    sequence_s64 m_beginSequence;
+    sequence_s64 m_publishedSequence;
+    int m_publishedSize;
+};
+
+template <int BlockSize, bool Compress>
+class TimeSeriesSharedMemoryReader
+{
+public:
+    typedef TimeSeriesSharedMemoryLayout<BlockSize, Compress> Layout;
+
+    TimeSeriesSharedMemoryReader() :
+        m_slotCount(0),
+        m_mappingSize(0),
+        m_mapping(nullptr),
+        m_header(nullptr),
+        m_lastBlock(nullptr),
+        m_lastSize(0),
+        m_container(std::numeric_limits<time_s64>::max())
+    {
+    }
+
+    TimeSeriesSharedMemoryReader(const TimeSeriesSharedMemoryReader&) = delete;
+    TimeSeriesSharedMemoryReader& operator=(const TimeSeriesSharedMemoryReader&) = delete;
+
+    ~TimeSeriesSharedMemoryReader()
+    {
+        detach();
+    }
+
+    bool attach(const char* name)
+    {
+        detach();
+
+        const int fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        void* mapping = mmap(nullptr, Layout::HeaderSize, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        const typename Layout::Header* header = static_cast<const typename Layout::Header*>(mapping);
+        const bool isValid = std::memcmp(header->magic, Layout::magic(), sizeof(header->magic)) == 0 &&
+                             header->blockSize == BlockSize && header->compress == Compress &&
+                             header->slotSize == Layout::SlotSize && header->slotCount > 0;
+        const int slotCount = header->slotCount;
+        munmap(mapping, Layout::HeaderSize);
+
+        if (!isValid)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        const size_t mappingSize = Layout::mappingSize(slotCount);
+        mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if (mapping == MAP_FAILED)
+        {
+            return false;
+        }
+
+        m_slotCount = slotCount;
+        m_mappingSize = mappingSize;
+        m_mapping = mapping;
+        m_header = static_cast<const typename Layout::Header*>(mapping);
+        return true;
+    }
+
+    void detach()
+    {
+        if (m_mapping)
+        {
+            munmap(m_mapping, m_mappingSize);
+            m_mapping = nullptr;
+            m_header = nullptr;
+        }
+    }
+
+    bool isAttached() const
+    {
+        return m_mapping != nullptr;
+    }
+
+    void refresh()
+    {
+        if (!m_mapping)
+        {
+            return;
+        }
+
+        const sequence_s64 endSequence = m_header->endSequence.load(std::memory_order_acquire);
+        const sequence_s64 firstSequence = m_header->firstSequence.load(std::memory_order_acquire);
+
+        m_container.removeBlocksBefore(m_container.blockCount() > 0 && firstSequence < m_container.blockSequence(0)
+                                       ? std::numeric_limits<sequence_s64>::max()
+                                       : firstSequence);
+        if (m_container.blockCount() == 0)
+        {
+            m_lastBlock = nullptr;
+        }
+
+        sequence_s64 sequence = m_lastBlock ? m_container.blockSequence(m_container.blockCount() - 1)
+                                            : firstSequence;
+
+        for (; sequence < endSequence; ++sequence)
+        {
+            const bool isLast = m_lastBlock && sequence == m_container.blockSequence(m_container.blockCount() - 1);
+            TimeSeriesDataBlock<BlockSize, Compress>* block = isLast ? m_lastBlock
+                                                         : new TimeSeriesDataBlock<BlockSize, Compress>(0, 0);
+
+            if (!readSlot(sequence, block, isLast ? m_lastSize : 0))
+            {
+                if (!isLast)
+                {
+                    delete block;
+                }
+
+                m_container.removeBlocksBefore(std::numeric_limits<sequence_s64>::max());
+                m_lastBlock = nullptr;
+                sequence = m_header->firstSequence.load(std::memory_order_acquire) - 1;
+                continue;
+            }
+
+            if (!isLast)
+            {
+                m_container.appendBlock(block, sequence);
+                m_lastBlock = block;
+            }
+            m_lastSize = block->size();
+        }
+    }
+
+    int blockCount() const
+    {
+        return m_container.blockCount();
+    }
+
+    TimeSeriesDataIterator<BlockSize, Compress> iter() const
+    {
+        return TimeSeriesDataIterator<BlockSize, Compress>(&m_container);
+    }
+
+    TimeSeriesDataRange<BlockSize, Compress> range(time_s64 beginTime = 0, time_s64 endTime = -1) const
+    {
+        return TimeSeriesDataRange<BlockSize, Compress>(&m_container, beginTime, endTime);
+    }
+
+private:
+    bool readSlot(sequence_s64 sequence, TimeSeriesDataBlock<BlockSize, Compress>* block, int fromSize)
+    {
+        const typename Layout::Slot* slot = Layout::slot(m_mapping, m_slotCount, sequence);
+
+        for (;;)
+        {
+            const value_u64 version = slot->version.load(std::memory_order_acquire);
+            if (version & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            TimeSeriesBlockImage image;
+            std::memcpy(&image, &slot->image, sizeof(image));
+
+            const bool isImported = image.sequence == sequence &&
+                                    block->importImage(image, Layout::payload(slot), fromSize);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot->version.load(std::memory_order_relaxed) != version)
+            {
+                continue;
+            }
+
+            return isImported;
+        }
+    }
+
+    int m_slotCount;
+    size_t m_mappingSize;
+    void* m_mapping;
+    const typename Layout::Header* m_header;
+    TimeSeriesDataBlock<BlockSize, Compress>* m_lastBlock;
+    int m_lastSize;
+    TimeSeriesDataContainer<BlockSize, Compress> m_container;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_SHARED_MEMORY_H
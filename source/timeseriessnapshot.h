@@ -0,0 +1,264 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_SNAPSHOT_H
+#define TIME_SERIES_SNAPSHOT_H
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "timeseriesaggregate.h"
+#include "timeseriesarraytypes.h"
+#include "timeseriesblockdirectory.h"
+#include "timeseriesdatablock.h"
+#include "timeseriesdatacontainer.h"
+
+namespace TimeSeries {
+
+template <int BlockSize, bool Compress>
+class TimeSeriesSnapshot
+{
+public:
+    typedef TimeSeriesDataBlock<BlockSize, Compress> Block;
+
+    TimeSeriesSnapshot(TimeSeriesDataContainer<BlockSize, Compress>* container) :
+        m_firstSequence(0),
+        m_container(container)
+    {
+        std::lock_guard<std::mutex> lock(m_container->structureMutex());
+
+        const int blockCount = m_container->blockCount();
+        m_blocks.resize(blockCount);
+        m_extents.resize(blockCount);
+        m_infos.resize(blockCount);
+
+        for (int index = 0; index < blockCount; ++index)
+        {
+            m_blocks[index] = m_container->block(index);
+            m_extents[index] = m_blocks[index]->committedExtent();
+            m_infos[index] = m_container->blockInfo(index);
+        }
+
+        m_firstSequence = blockCount > 0 ? m_container->blockSequence(0) : 0;
+        m_container->pinBlocks(m_firstSequence);
+    }
+
+    TimeSeriesSnapshot(TimeSeriesSnapshot&& other) noexcept :
+        m_firstSequence(other.m_firstSequence),
+        m_blocks(std::move(other.m_blocks)),
+        m_extents(std::move(other.m_extents)),
+        m_infos(std::move(other.m_infos)),
+        m_container(other.m_container)
+    {
+        other.m_container = nullptr;
+    }
+
+    TimeSeriesSnapshot(const TimeSeriesSnapshot&) = delete;
+    TimeSeriesSnapshot& operator=(const TimeSeriesSnapshot&) = delete;
+
+    ~TimeSeriesSnapshot()
+    {
+        release();
+    }
+
+    void release()
+    {
+        if (m_container)
+        {
+            m_container->unpinBlocks(m_firstSequence);
+            m_container = nullptr;
+            m_blocks.clear();
+            m_extents.clear();
+            m_infos.clear();
+        }
+    }
+
+    int blockCount() const
+    {
+        return static_cast<int>(m_blocks.size());
+    }
+
+    const TimeSeriesBlockInfo& blockInfo(int index) const
+    {
+        return m_infos[index];
+    }
+
+    bool isSummarized(int index) const
+    {
+        return index + 1 < blockCount();
+    }
+
+    void aggregateBlock(int blockIndex, time_s64 beginTime, time_s64 endTime, TimeSeriesAggregate& aggregate) const
+    {
+        if (isSummarized(blockIndex))
+        {
+            m_blocks[blockIndex]->aggregate(beginTime, endTime, aggregate);
+            return;
+        }
+
+        std::vector<time_s64> times(Block::MaxCount);
+        std::vector<value_u64> values(Block::MaxCount);
+        const int count = readBlock(blockIndex, times.data(), values.data());
+        const value_double* doubles = reinterpret_cast<const value_double*>(values.data());
+
+        for (int index = 0; index < count; ++index)
+        {
+            if (times[index] >= beginTime && times[index] <= endTime)
+            {
+                aggregate.add(doubles[index]);
+            }
+        }
+    }
+
+    size_t sampleCount() const
+    {
+        size_t count = 0;
+        for (const value_u64 extent : m_extents)
+        {
+            count += extent & 0xFFFFFFFF;
+        }
+        return count;
+    }
+
+    template <class Function>
+    void forEach(Function&& function) const
+    {
+        forEach(std::numeric_limits<time_s64>::min(), -1, function);
+    }
+
+    template <class Function>
+    void forEach(time_s64 beginTime, time_s64 endTime, Function&& function) const
+    {
+        forEach(beginTime, endTime, function, [] { return true; });
+    }
+
+    template <class Function, class Predicate>
+    int forEach(time_s64 beginTime, time_s64 endTime, Function&& function, Predicate&& proceed) const
+    {
+        int visitedCount = 0;
+        if (m_blocks.empty())
+        {
+            return visitedCount;
+        }
+
+        std::vector<time_s64> times(Block::MaxCount);
+        std::vector<value_u64> values(Block::MaxCount);
+
+        for (int blockIndex = findBlock(beginTime); blockIndex < blockCount() && proceed(); ++blockIndex)
+        {
+            const int count = readBlock(blockIndex, times.data(), values.data());
+            const value_double* doubles = reinterpret_cast<const value_double*>(values.data());
+            ++visitedCount;
+
+            if (blockIndex + 1 == blockCount() && times[count - 1] < beginTime)
+            {
+                return visitedCount;
+            }
+
+            int index = 0;
+            while (index + 1 < count && times[index + 1] <= beginTime)
+            {
+                ++index;
+            }
+
+            int endIndex = count;
+            if (endTime >= 0)
+            {
+                endIndex = static_cast<int>(std::lower_bound(times.data() + index, times.data() + count, endTime) -
+                                            times.data());
+            }
+
+            for (const int lastIndex = std::min(endIndex + 1, count); index < lastIndex; ++index)
+            {
+                function(times[index], doubles[index]);
+            }
+
+            if (endIndex < count)
+            {
+                return visitedCount;
+            }
+        }
+
+        return visitedCount;
+    }
+
+    TimeSeriesAggregate aggregate(time_s64 beginTime = 0, time_s64 endTime = -1) const
+    {
+        TimeSeriesAggregate aggregate;
+        if (endTime < 0)
+        {
+            endTime = std::numeric_limits<time_s64>::max();
+        }
+
+        forEach(beginTime, endTime, [&](time_s64 time, value_double value) {
+            if (time >= beginTime && time <= endTime)
+            {
+                aggregate.add(value);
+            }
+        });
+        return aggregate;
+    }
+
+private:
+    int readBlock(int blockIndex, time_s64* times, value_u64* values) const
+    {
+        if (blockIndex + 1 < blockCount())
+        {
+            return readFinal(m_blocks[blockIndex], times, values);
+        }
+
+        TimeSeriesBlockReadState state;
+        return m_blocks[blockIndex]->readExtent(state, m_extents[blockIndex], times, values, Block::MaxCount);
+    }
+
+    static int readFinal(const TimeSeriesDataBlock<BlockSize, true>* block, time_s64* times, value_u64* values)
+    {
+        return block->read(times, values);
+    }
+
+    static int readFinal(const TimeSeriesDataBlock<BlockSize, false>* block, time_s64* times, value_u64* values)
+    {
+        TimeSeriesBlockReadState state;
+        return block->readCommitted(state, times, values, Block::MaxCount);
+    }
+
+    int findBlock(time_s64 time) const
+    {
+        const auto block = std::upper_bound(m_blocks.begin() + 1, m_blocks.end(), time,
+                                            [](time_s64 time, const Block* block) {
+                                                return time < block->beginTime();
+                                            });
+        return static_cast<int>(block - m_blocks.begin()) - 1;
+    }
+
+    sequence_s64 m_firstSequence;
+    std::vector<const Block*> m_blocks;
+    std::vector<value_u64> m_extents;
+    std::vector<TimeSeriesBlockInfo> m_infos;
+    TimeSeriesDataContainer<BlockSize, Compress>* m_container;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_SNAPSHOT_H
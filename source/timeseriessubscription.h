@@ -0,0 +1,161 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_SUBSCRIPTION_H
+#define TIME_SERIES_SUBSCRIPTION_H
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "timeseriesarraytypes.h"
+#include "timeseriesdatablock.h"
+#include "timeseriesdatacontainer.h"
+
+namespace TimeSeries {
+
+template <int BlockSize, bool Compress>
+class TimeSeriesSubscription
+{
+public:
+    TimeSeriesSubscription(const TimeSeriesDataContainer<BlockSize, Compress>* container,
+                           time_s64 fromTime, int notifyCount) :
+        m_fromTime(fromTime),
+        m_notifyCount(notifyCount > 0 ? notifyCount : 1),
+        m_sequence(-1),
+        m_appendCount(0),
+        m_rolloverCount(0),
+        m_hasMore(true),
+        m_count(0),
+        m_offset(0),
+        m_times(TimeSeriesDataBlock<BlockSize, Compress>::MaxCount),
+        m_values(TimeSeriesDataBlock<BlockSize, Compress>::MaxCount),
+        m_container(container)
+    {
+    }
+
+    int poll()
+    {
+        std::lock_guard<std::mutex> lock(m_container->structureMutex());
+
+        m_appendCount = m_container->notifier().appendCount();
+        m_rolloverCount = m_container->notifier().rolloverCount();
+        m_hasMore = false;
+        m_count = 0;
+        m_offset = 0;
+
+        const int blockCount = m_container->blockCount();
+        if (blockCount == 0)
+        {
+            return 0;
+        }
+
+        const sequence_s64 firstSequence = m_container->blockSequence(0);
+        if (m_sequence < 0)
+        {
+            m_sequence = m_container->blockSequence(m_container->findBlock(m_fromTime));
+        }
+        else if (m_sequence < firstSequence)
+        {
+            m_sequence = firstSequence;
+            m_state = TimeSeriesBlockReadState();
+        }
+
+        for (int index = static_cast<int>(m_sequence - firstSequence); index < blockCount; ++index)
+        {
+            const TimeSeriesDataBlock<BlockSize, Compress>* block = m_container->block(index);
+            m_count = block->readCommitted(m_state, m_times.data(),
+                                           reinterpret_cast<value_u64*>(m_values.data()),
+                                           static_cast<int>(m_times.size()));
+
+            const bool isFinished = index + 1 < blockCount && m_state.sampleIndex >= block->count();
+            if (isFinished)
+            {
+                m_sequence++;
+                m_state = TimeSeriesBlockReadState();
+            }
+
+            if (m_count > 0 && m_times[m_count - 1] >= m_fromTime)
+            {
+                m_offset = static_cast<int>(std::lower_bound(m_times.data(), m_times.data() + m_count, m_fromTime) -
+                                            m_times.data());
+                m_count -= m_offset;
+                m_hasMore = isFinished;
+                return m_count;
+            }
+
+            m_count = 0;
+            if (!isFinished)
+            {
+                break;
+            }
+        }
+
+        return 0;
+    }
+
+    bool waitFor(int timeoutMillis)
+    {
+        if (m_hasMore)
+        {
+            return true;
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMillis);
+        return m_container->notifier().waitUntil(m_appendCount + m_notifyCount, m_rolloverCount, deadline);
+    }
+
+    int count() const
+    {
+        return m_count;
+    }
+
+    const time_s64* times() const
+    {
+        return m_times.data() + m_offset;
+    }
+
+    const value_double* values() const
+    {
+        return m_values.data() + m_offset;
+    }
+
+private:
+    time_s64 m_fromTime;
+    int m_notifyCount;
+    sequence_s64 m_sequence;
+    value_u64 m_appendCount;
+    value_u64 m_rolloverCount;
+    bool m_hasMore;
+
+    int m_count;
+    int m_offset;
+    std::vector<time_s64> m_times;
+    std::vector<value_double> m_values;
+    TimeSeriesBlockReadState m_state;
+    const TimeSeriesDataContainer<BlockSize, Compress>* m_container;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_SUBSCRIPTION_H
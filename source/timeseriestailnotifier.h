@@ -0,0 +1,155 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_TAIL_NOTIFIER_H
+#define TIME_SERIES_TAIL_NOTIFIER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "timeseriesarraytypes.h"
+
+namespace TimeSeries {
+
+class TimeSeriesTailNotifier
+{
+public:
+    TimeSeriesTailNotifier() :
+        m_appendCount(0),
+        m_rolloverCount(0),
+        m_wakeCount(std::numeric_limits<value_u64>::max()),
+        m_waiterCount(0),
+        m_isBarrierRegistered(registerBarrier())
+    {
+    }
+
+    TimeSeriesTailNotifier(const TimeSeriesTailNotifier&) = delete;
+    TimeSeriesTailNotifier& operator=(const TimeSeriesTailNotifier&) = delete;
+
+    value_u64 appendCount() const
+    {
+        return m_appendCount.load(std::memory_order_acquire);
+    }
+
+    value_u64 rolloverCount() const
+    {
+        return m_rolloverCount.load(std::memory_order_acquire);
+    }
+
+    void notify(bool isRollover)
+    {
+        const value_u64 appendCount = m_appendCount.load(std::memory_order_relaxed) + 1;
+        m_appendCount.store(appendCount, std::memory_order_release);
+
+        if (isRollover)
+        {
+            m_rolloverCount.store(m_rolloverCount.load(std::memory_order_relaxed) + 1,
+                                  std::memory_order_release);
+        }
+
+        if (m_isBarrierRegistered)
+        {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        }
+        else
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+
+        if (m_waiterCount.load(std::memory_order_relaxed) > 0 &&
+            (isRollover || appendCount >= m_wakeCount.load(std::memory_order_relaxed)))
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_wakeCount.store(std::numeric_limits<value_u64>::max(), std::memory_order_relaxed);
+            }
+            m_condition.notify_all();
+        }
+    }
+
+    bool waitUntil(value_u64 appendCount, value_u64 rolloverCount,
+                   std::chrono::steady_clock::time_point deadline)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_waiterCount.fetch_add(1);
+
+        bool isNotified = true;
+        for (;;)
+        {
+            if (appendCount < m_wakeCount.load(std::memory_order_relaxed))
+            {
+                m_wakeCount.store(appendCount, std::memory_order_relaxed);
+            }
+
+            if (m_isBarrierRegistered)
+            {
+                syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+            }
+            else
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+
+            if (m_appendCount.load(std::memory_order_acquire) >= appendCount ||
+                m_rolloverCount.load(std::memory_order_acquire) != rolloverCount)
+            {
+                break;
+            }
+            if (m_condition.wait_until(lock, deadline) == std::cv_status::timeout)
+            {
+                isNotified = m_appendCount.load(std::memory_order_acquire) >= appendCount ||
+                             m_rolloverCount.load(std::memory_order_acquire) != rolloverCount;
+                break;
+            }
+        }
+
+        m_waiterCount.fetch_sub(1);
+        return isNotified;
+    }
+
+private:
+    static bool registerBarrier()
+    {
+        static const bool isRegistered =
+            syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0;
+        return isRegistered;
+    }
+
+    std::atomic<value_u64> m_appendCount;
+    std::atomic<value_u64> m_rolloverCount;
+    std::atomic<value_u64> m_wakeCount;
+    std::atomic<int> m_waiterCount;
+    bool m_isBarrierRegistered;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_TAIL_NOTIFIER_H
@@ -0,0 +1,75 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_TIME_UNIT_H
+#define TIME_SERIES_TIME_UNIT_H
+
+#include <chrono>
+
+#include "timeseriesarraytypes.h"
+
+namespace TimeSeries {
+
+enum class TimeSeriesTimeUnit
+{
+    Nanoseconds,
+    Microseconds,
+    Milliseconds,
+    Seconds
+};
+
+template <class Rep, class Period>
+time_s64 toTimeUnits(std::chrono::duration<Rep, Period> duration, TimeSeriesTimeUnit timeUnit)
+{
+    switch (timeUnit)
+    {
+    case TimeSeriesTimeUnit::Nanoseconds:
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    case TimeSeriesTimeUnit::Microseconds:
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    case TimeSeriesTimeUnit::Seconds:
+        return std::chrono::duration_cast<std::chrono::seconds>(duration).count();
+    case TimeSeriesTimeUnit::Milliseconds:
+    default:
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    }
+}
+
+inline value_double timeUnitsPerSecond(TimeSeriesTimeUnit timeUnit)
+{
+    switch (timeUnit)
+    {
+    case TimeSeriesTimeUnit::Nanoseconds:
+        return 1e9;
+    case TimeSeriesTimeUnit::Microseconds:
+        return 1e6;
+    case TimeSeriesTimeUnit::Seconds:
+        return 1.0;
+    case TimeSeriesTimeUnit::Milliseconds:
+    default:
+        return 1e3;
+    }
+}
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_TIME_UNIT_H
@@ -0,0 +1,211 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_TRACE_H
+#define TIME_SERIES_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+
+#include "timeseriesarraytypes.h"
+
+namespace TimeSeries {
+
+template <class Unused = void>
+class TimeSeriesTraceRing
+{
+public:
+    static const value_u64 Capacity = 1 << 16;
+
+    static bool isEnabled()
+    {
+        return s_isEnabled.load(std::memory_order_relaxed);
+    }
+
+    static void enable()
+    {
+        s_isEnabled.store(true, std::memory_order_relaxed);
+    }
+
+    static void disable()
+    {
+        s_isEnabled.store(false, std::memory_order_relaxed);
+    }
+
+    static void clear()
+    {
+        s_clearIndex.store(s_head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    static value_u64 now()
+    {
+        return static_cast<value_u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static void record(const char* name, value_u64 beginTime, value_u64 endTime, value_u64 argument)
+    {
+        const value_u64 index = s_head.fetch_add(1, std::memory_order_relaxed);
+        Event& event = s_events[index & (Capacity - 1)];
+
+        event.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        event.name.store(name, std::memory_order_relaxed);
+        event.beginTime.store(beginTime, std::memory_order_relaxed);
+        event.duration.store(endTime - beginTime, std::memory_order_relaxed);
+        event.argument.store(argument, std::memory_order_relaxed);
+        event.thread.store(threadIndex(), std::memory_order_relaxed);
+        event.sequence.store(2 * index + 2, std::memory_order_release);
+    }
+
+    static size_t writeChromeTrace(std::ostream& output)
+    {
+        const value_u64 head = s_head.load(std::memory_order_acquire);
+        const value_u64 clearIndex = s_clearIndex.load(std::memory_order_acquire);
+        value_u64 index = head > Capacity ? head - Capacity : 0;
+        index = index > clearIndex ? index : clearIndex;
+
+        size_t eventCount = 0;
+        output << "{\"traceEvents\":[";
+
+        for (; index < head; ++index)
+        {
+            const Event& event = s_events[index & (Capacity - 1)];
+            if (event.sequence.load(std::memory_order_acquire) != 2 * index + 2)
+            {
+                continue;
+            }
+
+            const char* name = event.name.load(std::memory_order_relaxed);
+            const value_u64 beginTime = event.beginTime.load(std::memory_order_relaxed);
+            const value_u64 duration = event.duration.load(std::memory_order_relaxed);
+            const value_u64 argument = event.argument.load(std::memory_order_relaxed);
+            const int thread = event.thread.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (event.sequence.load(std::memory_order_relaxed) != 2 * index + 2)
+            {
+                continue;
+            }
+
+            output << (eventCount++ ? ",\n" : "\n")
+                   << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+                   << ",\"ts\":";
+            writeMicroseconds(output, beginTime);
+            output << ",\"dur\":";
+            writeMicroseconds(output, duration);
+            output << ",\"args\":{\"value\":" << argument << "}}";
+        }
+
+        output << "\n],\"displayTimeUnit\":\"ns\"}\n";
+        return eventCount;
+    }
+
+private:
+    struct Event
+    {
+        std::atomic<value_u64> sequence;
+        std::atomic<const char*> name;
+        std::atomic<value_u64> beginTime;
+        std::atomic<value_u64> duration;
+        std::atomic<value_u64> argument;
+        std::atomic<int> thread;
+    };
+
+    static void writeMicroseconds(std::ostream& output, value_u64 nanoseconds)
+    {
+        const value_u64 fraction = nanoseconds % 1000;
+        output << nanoseconds / 1000 << "." << fraction / 100 << (fraction / 10) % 10 << fraction % 10;
+    }
+
+    static int threadIndex()
+    {
+        static std::atomic<int> s_threadCount(0);
+        static thread_local int s_threadIndex = ++s_threadCount;
+        return s_threadIndex;
+    }
+
+    static std::atomic<bool> s_isEnabled;
+    static std::atomic<value_u64> s_head;
+    static std::atomic<value_u64> s_clearIndex;
+    static Event s_events[Capacity];
+};
+
+template <class Unused>
+std::atomic<bool> TimeSeriesTraceRing<Unused>::s_isEnabled(false);
+
+template <class Unused>
+std::atomic<value_u64> TimeSeriesTraceRing<Unused>::s_head(0);
+
+template <class Unused>
+std::atomic<value_u64> TimeSeriesTraceRing<Unused>::s_clearIndex(0);
+
+template <class Unused>
+typename TimeSeriesTraceRing<Unused>::Event TimeSeriesTraceRing<Unused>::s_events[TimeSeriesTraceRing<Unused>::Capacity];
+
+typedef TimeSeriesTraceRing<> TimeSeriesTrace;
+
+class TimeSeriesTraceScope
+{
+public:
+    TimeSeriesTraceScope(const char* name, value_u64 argument = 0) :
+        m_name(name),
+        m_argument(argument),
+        m_beginTime(TimeSeriesTrace::isEnabled() ? TimeSeriesTrace::now() : 0)
+    {
+    }
+
+    TimeSeriesTraceScope(const TimeSeriesTraceScope&) = delete;
+    TimeSeriesTraceScope& operator=(const TimeSeriesTraceScope&) = delete;
+
+    ~TimeSeriesTraceScope()
+    {
+        if (m_beginTime)
+        {
+            TimeSeriesTrace::record(m_name, m_beginTime, TimeSeriesTrace::now(), m_argument);
+        }
+    }
+
+    void setArgument(value_u64 argument)
+    {
+        m_argument = argument;
+    }
+
+private:
+    const char* m_name;
+    value_u64 m_argument;
+    value_u64 m_beginTime;
+};
+
+} // namespace TimeSeries
+
+#ifdef TIME_SERIES_TRACE
+#define TIME_SERIES_TRACE_CONCAT_(a, b) a##b
+#define TIME_SERIES_TRACE_CONCAT(a, b) TIME_SERIES_TRACE_CONCAT_(a, b)
+#define TIME_SERIES_TRACE_SCOPE(name, argument) \
+    TimeSeries::TimeSeriesTraceScope TIME_SERIES_TRACE_CONCAT(traceScope, __LINE__)(name, argument)
+#else
+#define TIME_SERIES_TRACE_SCOPE(name, argument) ((void)0)
+#endif
+
+#endif // TIME_SERIES_TRACE_H
@@ -0,0 +1,212 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef TIME_SERIES_VERTEX_WRITER_H
+#define TIME_SERIES_VERTEX_WRITER_H
+
+#include <algorithm>
+#include <limits>
+
+#include "timeseriesarraytypes.h"
+#include "timeseriesblockdecoder.h"
+#include "timeseriesdatacontainer.h"
+
+namespace TimeSeries {
+
+template <int BlockSize, bool Compress>
+class TimeSeriesVertexWriter
+{
+public:
+    TimeSeriesVertexWriter(const TimeSeriesDataContainer<BlockSize, Compress>* container,
+                           time_s64 originTime, float timeScale,
+                           value_double valueOffset, float valueScale) :
+        m_originTime(originTime),
+        m_timeScale(timeScale),
+        m_valueOffset(valueOffset),
+        m_valueScale(valueScale),
+        m_container(container)
+    {
+    }
+
+    ~TimeSeriesVertexWriter() = default;
+
+    int write(time_s64 beginTime, time_s64 endTime, float* out, int capacity)
+    {
+        int written = 0;
+        if (endTime < 0)
+        {
+            endTime = std::numeric_limits<time_s64>::max();
+        }
+
+        for (int blockIndex = m_container->findBlock(beginTime);
+             blockIndex < m_container->blockCount() && written < capacity;
+             ++blockIndex)
+        {
+            const int count = m_decoder.decode(m_container, blockIndex);
+            const time_s64* times = m_decoder.times();
+            const value_double* values = m_decoder.values();
+
+            int beginIndex = 0;
+            while (beginIndex + 1 < count && times[beginIndex + 1] <= beginTime)
+            {
+                ++beginIndex;
+            }
+
+            int endIndex = beginIndex;
+            while (endIndex < count && times[endIndex] < endTime)
+            {
+                ++endIndex;
+            }
+
+            const bool isLast = endIndex < count;
+            endIndex += isLast ? 1 : 0;
+
+            const int vertexCount = std::min(endIndex - beginIndex, capacity - written);
+            convert(times + beginIndex, values + beginIndex, vertexCount, out + written * 2);
+            written += vertexCount;
+
+            if (isLast)
+            {
+                break;
+            }
+        }
+
+        return written;
+    }
+
+    int writeMinMax(time_s64 beginTime, time_s64 endTime, time_s64 bucketTime,
+                    float* out, int capacity)
+    {
+        int written = 0;
+        time_s64 bucketEnd = beginTime;
+        time_s64 minTime = 0;
+        time_s64 maxTime = 0;
+        value_double minValue = 0.0;
+        value_double maxValue = 0.0;
+        bool hasBucket = false;
+        if (endTime < 0)
+        {
+            endTime = std::numeric_limits<time_s64>::max();
+        }
+
+        for (int blockIndex = m_container->findBlock(beginTime);
+             blockIndex < m_container->blockCount();
+             ++blockIndex)
+        {
+            const int count = m_decoder.decode(m_container, blockIndex);
+            const time_s64* times = m_decoder.times();
+            const value_double* values = m_decoder.values();
+
+            for (int index = 0; index < count; ++index)
+            {
+                const time_s64 time = times[index];
+                const value_double value = values[index];
+
+                if (time < beginTime && index + 1 < count && times[index + 1] <= beginTime)
+                {
+                    continue;
+                }
+
+                if (!hasBucket || time >= bucketEnd)
+                {
+                    if (hasBucket && !flush(minTime, minValue, maxTime, maxValue, out, capacity, written))
+                    {
+                        return written;
+                    }
+
+                    bucketEnd = time < beginTime ? beginTime
+                              : beginTime + ((time - beginTime) / bucketTime + 1) * bucketTime;
+                    minTime = maxTime = time;
+                    minValue = maxValue = value;
+                    hasBucket = true;
+                }
+                else if (value < minValue)
+                {
+                    minTime = time;
+                    minValue = value;
+                }
+                else if (value > maxValue)
+                {
+                    maxTime = time;
+                    maxValue = value;
+                }
+
+                if (time >= endTime)
+                {
+                    flush(minTime, minValue, maxTime, maxValue, out, capacity, written);
+                    return written;
+                }
+            }
+        }
+
+        if (hasBucket)
+        {
+            flush(minTime, minValue, maxTime, maxValue, out, capacity, written);
+        }
+
+        return written;
+    }
+
+private:
+    void convert(const time_s64* times, const value_double* values, int count, float* out) const
+    {
+        const time_s64 originTime = m_originTime;
+        const float timeScale = m_timeScale;
+        const value_double valueOffset = m_valueOffset;
+        const value_double valueScale = m_valueScale;
+
+        for (int index = 0; index < count; ++index)
+        {
+            out[index * 2] = static_cast<float>(times[index] - originTime) * timeScale;
+            out[index * 2 + 1] = static_cast<float>((values[index] - valueOffset) * valueScale);
+        }
+    }
+
+    bool flush(time_s64 minTime, value_double minValue, time_s64 maxTime, value_double maxValue,
+               float* out, int capacity, int& written) const
+    {
+        const int vertexCount = minTime == maxTime ? 1 : 2;
+        if (written + vertexCount > capacity)
+        {
+            return false;
+        }
+
+        const time_s64 times[2] = { std::min(minTime, maxTime), std::max(minTime, maxTime) };
+        const value_double values[2] = { minTime < maxTime ? minValue : maxValue,
+                                         minTime < maxTime ? maxValue : minValue };
+        convert(times, values, vertexCount, out + written * 2);
+        written += vertexCount;
+        return true;
+    }
+
+    time_s64 m_originTime;
+    float m_timeScale;
+    value_double m_valueOffset;
+    float m_valueScale;
+    TimeSeriesBlockDecoder<BlockSize, Compress> m_decoder;
+    const TimeSeriesDataContainer<BlockSize, Compress>* m_container;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_VERTEX_WRITER_H
@@ -0,0 +1,754 @@
+// MIT License
+//
+// Copyright (c) 2018 Harri Smatt
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TIME_SERIES_WRITE_AHEAD_LOG_H
+#define TIME_SERIES_WRITE_AHEAD_LOG_H
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "timeseriesarraytypes.h"
+#include "timeseriesblockimage.h"
+#include "timeseriesdatablock.h"
+#include "timeseriesdatacontainer.h"
+
+namespace TimeSeries {
+
+enum class TimeSeriesSyncPolicy
+{
+    None,
+    Interval,
+    Always
+};
+
+template <int BlockSize, bool Compress>
+class TimeSeriesWriteAheadLog
+{
+public:
+    typedef TimeSeriesDataBlock<BlockSize, Compress> Block;
+
+    TimeSeriesWriteAheadLog(TimeSeriesDataContainer<BlockSize, Compress>* container) :
+        m_container(container),
+        m_file(-1),
+        m_isDirect(false),
+        m_isWriteFailed(false),
+        m_buffer(nullptr),
+        m_bufferSize(0),
+        m_bufferOffset(0),
+        m_checkpointSize(0),
+        m_loggedTime(std::numeric_limits<time_s64>::min()),
+        m_loggedExtent(0),
+        m_payload(Block::PayloadSize),
+        m_commitInterval(0),
+        m_syncInterval(0),
+        m_syncPolicy(TimeSeriesSyncPolicy::None),
+        m_isRunning(false),
+        m_isFailed(false),
+        m_requestCount(0),
+        m_commitCount(0)
+    {
+    }
+
+    TimeSeriesWriteAheadLog(const TimeSeriesWriteAheadLog&) = delete;
+    TimeSeriesWriteAheadLog& operator=(const TimeSeriesWriteAheadLog&) = delete;
+
+    ~TimeSeriesWriteAheadLog()
+    {
+        close();
+        std::free(m_buffer);
+    }
+
+    bool open(const char* path, int commitIntervalMillis, TimeSeriesSyncPolicy syncPolicy,
+              int syncIntervalMillis = 1000)
+    {
+        close();
+
+        m_path = path;
+        m_loggedTime = std::numeric_limits<time_s64>::min();
+        m_loggedExtent = 0;
+        m_ranges.clear();
+        m_isFailed = false;
+        m_requestCount = 0;
+        m_commitCount = 0;
+
+        if (!m_buffer && posix_memalign(reinterpret_cast<void**>(&m_buffer), Alignment, BufferSize) != 0)
+        {
+            m_buffer = nullptr;
+            return false;
+        }
+        if (!checkpoint())
+        {
+            return false;
+        }
+
+        m_commitInterval = std::chrono::milliseconds(commitIntervalMillis);
+        m_syncInterval = std::chrono::milliseconds(syncIntervalMillis);
+        m_syncPolicy = syncPolicy;
+        m_isRunning = true;
+        m_thread = std::thread(&TimeSeriesWriteAheadLog::run, this);
+        return true;
+    }
+
+    void close()
+    {
+        if (m_file < 0)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_isRunning = false;
+        }
+        m_condition.notify_one();
+        m_thread.join();
+
+        ::close(m_file);
+        m_file = -1;
+    }
+
+    bool isOpen() const
+    {
+        return m_file >= 0;
+    }
+
+    bool isFailed() const
+    {
+        return m_isFailed.load(std::memory_order_acquire);
+    }
+
+    void logRange(time_s64 beginTime, time_s64 endTime)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ranges.push_back(std::make_pair(beginTime, endTime));
+    }
+
+    bool flush()
+    {
+        if (m_file < 0)
+        {
+            return false;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const value_u64 requestCount = ++m_requestCount;
+        m_condition.notify_one();
+        m_commitCondition.wait(lock, [&]() {
+            return m_commitCount >= requestCount;
+        });
+        return !isFailed();
+    }
+
+    static long replay(const char* path, std::vector<Block*>& replayBlocks)
+    {
+        FILE* file = std::fopen(path, "rb");
+        if (!file)
+        {
+            return 0;
+        }
+
+        char fileMagic[MagicSize];
+        const size_t magicSize = std::fread(fileMagic, 1, MagicSize, file);
+        if (magicSize != MagicSize || std::memcmp(fileMagic, magic(), MagicSize) != 0)
+        {
+            std::fclose(file);
+            return magicSize == 0 ? 0 : -1;
+        }
+
+        std::map<time_s64, Block*> blocks;
+        std::vector<value_u8> payload(Block::PayloadSize);
+        ChunkHeader header;
+        long validSize = MagicSize;
+
+        while (std::fread(&header, sizeof(header), 1, file) == 1)
+        {
+            const auto block = blocks.find(header.beginTime);
+            if (!isValid(header) || (header.offset > 0 && block == blocks.end()) ||
+                !readPayload(file, header, payload.data()))
+            {
+                break;
+            }
+
+            TimeSeriesBlockImage image;
+            image.sequence = 0;
+            image.beginTime = header.beginTime;
+            image.endTime = header.beginTime;
+            image.beginValue = header.beginValue;
+            image.endValue = header.beginValue;
+            image.count = static_cast<int>(header.count);
+            image.size = static_cast<int>(header.size);
+
+            Block* target = header.offset > 0 ? block->second : new Block(header.beginTime, header.beginValue);
+            if (!target->importImage(image, payload.data(), fromSize(header)))
+            {
+                if (header.offset == 0)
+                {
+                    delete target;
+                }
+                break;
+            }
+
+            if (header.offset == 0)
+            {
+                if (block != blocks.end())
+                {
+                    delete block->second;
+                }
+                blocks[header.beginTime] = target;
+            }
+            validSize += sizeof(header) + payloadSize(header);
+        }
+
+        std::fclose(file);
+
+        std::vector<time_s64> times(Block::MaxCount);
+        std::vector<value_u64> values(Block::MaxCount);
+        for (const auto& block : blocks)
+        {
+            TimeSeriesBlockReadState state;
+            const int count = block.second->readCommitted(state, times.data(), values.data(), Block::MaxCount);
+            delete block.second;
+
+            if (!replayBlocks.empty() && times[0] <= replayBlocks.back()->endTime())
+            {
+                continue;
+            }
+
+            for (int index = 0; index < count; ++index)
+            {
+                if (index == 0 || !replayBlocks.back()->append(times[index], values[index]))
+                {
+                    if (!replayBlocks.empty())
+                    {
+                        replayBlocks.back()->seal();
+                    }
+                    replayBlocks.push_back(new Block(times[index], values[index]));
+                }
+            }
+        }
+
+        return validSize;
+    }
+
+private:
+    static const int MagicSize = 8;
+    static const size_t Alignment = 4096;
+    static const size_t BufferSize = (Block::PayloadSize + 2 * Alignment) > (1 << 20) ?
+                                     (Block::PayloadSize + 2 * Alignment) & ~(Alignment - 1) : (1 << 20);
+    static const off_t CheckpointSize = 1 << 24;
+
+    struct ChunkHeader
+    {
+        time_s64 beginTime;
+        value_u64 beginValue;
+        value_u32 count;
+        value_u32 size;
+        value_u32 offset;
+        value_u32 checksum;
+    };
+
+    struct Chunk
+    {
+        const Block* block;
+        value_u64 extent;
+        value_u64 loggedExtent;
+    };
+
+    static const char* magic()
+    {
+        return "TSWAL002";
+    }
+
+    static bool isValid(const ChunkHeader& header)
+    {
+        if (header.count < 1 || header.count > static_cast<value_u32>(Block::MaxCount))
+        {
+            return false;
+        }
+        if (Compress)
+        {
+            return header.size <= static_cast<value_u32>(Block::PayloadSize) && header.offset <= header.size &&
+                   (header.offset == 0 || header.size - header.offset >= 16);
+        }
+        return header.size + 1 == header.count && header.offset < header.count;
+    }
+
+    static size_t payloadSize(const ChunkHeader& header)
+    {
+        return Compress ? header.size - header.offset : (header.count - header.offset) * 16;
+    }
+
+    static int fromSize(const ChunkHeader& header)
+    {
+        return static_cast<int>(Compress && header.offset > 0 ? header.offset + 16 : header.offset);
+    }
+
+    static bool readPayload(FILE* file, const ChunkHeader& header, value_u8* payload)
+    {
+        value_u64 sum = 0;
+        value_u64 sumOfSums = 0;
+        checksum(reinterpret_cast<const value_u8*>(&header), offsetof(ChunkHeader, checksum), sum, sumOfSums);
+
+        if (Compress)
+        {
+            const size_t size = payloadSize(header);
+            if (std::fread(payload + header.offset, 1, size, file) != size)
+            {
+                return false;
+            }
+            checksum(payload + header.offset, size, sum, sumOfSums);
+        }
+        else
+        {
+            const size_t size = (header.count - header.offset) * 8;
+            value_u8* times = payload + header.offset * 8;
+            value_u8* values = payload + Block::MaxCount * 8 + header.offset * 8;
+            if (std::fread(times, 1, size, file) != size || std::fread(values, 1, size, file) != size)
+            {
+                return false;
+            }
+            checksum(times, size, sum, sumOfSums);
+            checksum(values, size, sum, sumOfSums);
+        }
+
+        return foldChecksum(sum, sumOfSums) == header.checksum;
+    }
+
+    static void checksum(const value_u8* data, size_t size, value_u64& sum, value_u64& sumOfSums)
+    {
+        value_u64 word;
+        for (; size >= 8; data += 8, size -= 8)
+        {
+            std::memcpy(&word, data, 8);
+            sum += word;
+            sumOfSums += sum;
+        }
+
+        word = 0;
+        std::memcpy(&word, data, size);
+        sum += word + size;
+        sumOfSums += sum;
+    }
+
+    static value_u32 foldChecksum(value_u64 sum, value_u64 sumOfSums)
+    {
+        const value_u64 hash = sum ^ (sumOfSums * 0x9E3779B97F4A7C15ull);
+        return static_cast<value_u32>(hash ^ (hash >> 32));
+    }
+
+    void writeChunk(const TimeSeriesDataBlock<BlockSize, true>* block, const Chunk& chunk, ChunkHeader& header)
+    {
+        const value_u8* data = block->data();
+        if (block->isCold())
+        {
+            TimeSeriesBlockImage image;
+            block->exportImage(image, m_payload.data(), 0);
+            header.count = static_cast<value_u32>(image.count);
+            header.size = static_cast<value_u32>(image.size);
+            header.offset = 0;
+            data = m_payload.data();
+        }
+        else
+        {
+            const int loggedSize = static_cast<int>(chunk.loggedExtent >> 32);
+            header.count = static_cast<value_u32>(chunk.extent & 0xFFFFFFFF);
+            header.size = static_cast<value_u32>(chunk.extent >> 32);
+            header.offset = loggedSize > 16 ? loggedSize - 16 : 0;
+        }
+
+        value_u8* output = beginChunk(header);
+        value_u64 sum = 0;
+        value_u64 sumOfSums = 0;
+        checksum(reinterpret_cast<const value_u8*>(&header), offsetof(ChunkHeader, checksum), sum, sumOfSums);
+        copy(output, data + header.offset, header.size - header.offset, sum, sumOfSums);
+        endChunk(header, sum, sumOfSums);
+    }
+
+    void writeChunk(const TimeSeriesDataBlock<BlockSize, false>* block, const Chunk& chunk, ChunkHeader& header)
+    {
+        time_s64* times = nullptr;
+        value_u64* values = nullptr;
+        block->read(times, values);
+
+        header.count = static_cast<value_u32>(chunk.extent & 0xFFFFFFFF);
+        header.size = header.count - 1;
+        header.offset = static_cast<value_u32>(chunk.loggedExtent & 0xFFFFFFFF);
+
+        const size_t size = (header.count - header.offset) * 8;
+        value_u8* output = beginChunk(header);
+        value_u64 sum = 0;
+        value_u64 sumOfSums = 0;
+        checksum(reinterpret_cast<const value_u8*>(&header), offsetof(ChunkHeader, checksum), sum, sumOfSums);
+        copy(output, reinterpret_cast<const value_u8*>(times + header.offset), size, sum, sumOfSums);
+        copy(output + size, reinterpret_cast<const value_u8*>(values + header.offset), size, sum, sumOfSums);
+        endChunk(header, sum, sumOfSums);
+    }
+
+    value_u8* beginChunk(const ChunkHeader& header)
+    {
+        if (m_bufferSize + sizeof(header) + payloadSize(header) > BufferSize && !flushBuffer())
+        {
+            m_isWriteFailed = true;
+            m_bufferSize = 0;
+        }
+        return m_buffer + m_bufferSize + sizeof(header);
+    }
+
+    void endChunk(ChunkHeader& header, value_u64 sum, value_u64 sumOfSums)
+    {
+        header.checksum = foldChecksum(sum, sumOfSums);
+        std::memcpy(m_buffer + m_bufferSize, &header, sizeof(header));
+        m_bufferSize += sizeof(header) + payloadSize(header);
+    }
+
+    static void copy(value_u8* output, const value_u8* input, size_t size, value_u64& sum, value_u64& sumOfSums)
+    {
+        value_u64 word;
+        for (; size >= 8; input += 8, output += 8, size -= 8)
+        {
+            std::memcpy(&word, input, 8);
+            std::memcpy(output, &word, 8);
+            sum += word;
+            sumOfSums += sum;
+        }
+
+        word = 0;
+        std::memcpy(&word, input, size);
+        std::memcpy(output, input, size);
+        sum += word + size;
+        sumOfSums += sum;
+    }
+
+    bool flushBuffer()
+    {
+        size_t writeSize = m_bufferSize;
+        if (m_isDirect)
+        {
+            writeSize = (m_bufferSize + Alignment - 1) & ~(Alignment - 1);
+            std::memset(m_buffer + m_bufferSize, 0, writeSize - m_bufferSize);
+        }
+
+        for (size_t writtenSize = 0; writtenSize < writeSize;)
+        {
+            const ssize_t size = ::pwrite(m_file, m_buffer + writtenSize, writeSize - writtenSize,
+                                          m_bufferOffset + static_cast<off_t>(writtenSize));
+            if (size < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (size < 0 && errno == EINVAL && m_isDirect)
+            {
+                m_isDirect = false;
+                writeSize = m_bufferSize;
+                if (fcntl(m_file, F_SETFL, fcntl(m_file, F_GETFL) & ~O_DIRECT) != 0)
+                {
+                    return false;
+                }
+                continue;
+            }
+            if (size <= 0)
+            {
+                return false;
+            }
+            writtenSize += static_cast<size_t>(size);
+        }
+
+        const size_t keepSize = m_isDirect ? m_bufferSize & (Alignment - 1) : 0;
+        std::memmove(m_buffer, m_buffer + m_bufferSize - keepSize, keepSize);
+        m_bufferOffset += static_cast<off_t>(m_bufferSize - keepSize);
+        m_bufferSize = keepSize;
+        return true;
+    }
+
+    off_t fileSize() const
+    {
+        return m_bufferOffset + static_cast<off_t>(m_bufferSize);
+    }
+
+    bool logBlocks(const std::vector<std::pair<time_s64, time_s64>>& ranges)
+    {
+        std::vector<Chunk> chunks;
+        sequence_s64 sequence = 0;
+        time_s64 loggedTime = m_loggedTime;
+        value_u64 loggedExtent = m_loggedExtent;
+
+        {
+            std::lock_guard<std::mutex> lock(m_container->structureMutex());
+
+            const int blockCount = m_container->blockCount();
+            if (blockCount == 0)
+            {
+                return true;
+            }
+
+            int index = m_container->findBlock(m_loggedTime);
+            if (m_container->block(index)->beginTime() < m_loggedTime)
+            {
+                ++index;
+            }
+            int firstIndex = index;
+
+            for (const auto& range : ranges)
+            {
+                for (int rangeIndex = m_container->findBlock(range.first);
+                     rangeIndex < index && m_container->block(rangeIndex)->beginTime() <= range.second;
+                     ++rangeIndex)
+                {
+                    const Block* block = m_container->block(rangeIndex);
+                    if (block->beginTime() >= range.first)
+                    {
+                        const Chunk chunk = { block, block->committedExtent(), 0 };
+                        chunks.push_back(chunk);
+                        firstIndex = std::min(firstIndex, rangeIndex);
+                    }
+                }
+            }
+
+            for (; index < blockCount; ++index)
+            {
+                const Block* block = m_container->block(index);
+                const Chunk chunk = { block, block->committedExtent(),
+                                      block->beginTime() == m_loggedTime ? m_loggedExtent : 0 };
+                loggedTime = block->beginTime();
+                loggedExtent = chunk.extent;
+                chunks.push_back(chunk);
+            }
+
+            if (chunks.empty())
+            {
+                return true;
+            }
+
+            sequence = m_container->blockSequence(firstIndex);
+            m_container->pinBlocks(sequence);
+        }
+
+        m_isWriteFailed = false;
+        for (const Chunk& chunk : chunks)
+        {
+            if (chunk.extent != chunk.loggedExtent)
+            {
+                ChunkHeader header;
+                header.beginTime = chunk.block->beginTime();
+                header.beginValue = chunk.block->beginValue();
+                writeChunk(chunk.block, chunk, header);
+            }
+        }
+        m_container->unpinBlocks(sequence);
+
+        if (m_isWriteFailed || !flushBuffer())
+        {
+            return false;
+        }
+
+        m_loggedTime = loggedTime;
+        m_loggedExtent = loggedExtent;
+        return true;
+    }
+
+    bool openFile(const std::string& path)
+    {
+        int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+#ifdef O_DIRECT
+        m_file = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        m_isDirect = m_file >= 0;
+#endif
+        if (!m_isDirect)
+        {
+            m_file = ::open(path.c_str(), flags, 0644);
+        }
+
+        m_bufferSize = 0;
+        m_bufferOffset = 0;
+        return m_file >= 0;
+    }
+
+    bool checkpoint()
+    {
+        const std::string path = m_path + ".checkpoint";
+        const int file = m_file;
+        if (!openFile(path))
+        {
+            m_file = file;
+            return false;
+        }
+
+        m_loggedTime = std::numeric_limits<time_s64>::min();
+        m_loggedExtent = 0;
+        std::memcpy(m_buffer, magic(), MagicSize);
+        m_bufferSize = MagicSize;
+
+        if (!logBlocks(std::vector<std::pair<time_s64, time_s64>>()) || !flushBuffer() ||
+            fdatasync(m_file) != 0 || std::rename(path.c_str(), m_path.c_str()) != 0 || !syncDirectory())
+        {
+            ::close(m_file);
+            ::unlink(path.c_str());
+            m_file = file;
+            return false;
+        }
+
+        if (file >= 0)
+        {
+            ::close(file);
+        }
+        m_checkpointSize = fileSize() * 2 + CheckpointSize;
+        return true;
+    }
+
+    bool syncDirectory() const
+    {
+        const size_t separator = m_path.rfind('/');
+        const std::string directory = separator == std::string::npos ? "." : m_path.substr(0, separator + 1);
+
+        const int file = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (file < 0)
+        {
+            return false;
+        }
+
+        const bool isSuccess = fsync(file) == 0;
+        ::close(file);
+        return isSuccess;
+    }
+
+    bool commit(const std::vector<std::pair<time_s64, time_s64>>& ranges, bool isSync)
+    {
+        const off_t syncedSize = fileSize();
+        if (!logBlocks(ranges) || (isSync && fdatasync(m_file) != 0))
+        {
+            return false;
+        }
+#ifdef __linux__
+        if (!isSync && !m_isDirect && m_syncPolicy != TimeSeriesSyncPolicy::None && fileSize() > syncedSize)
+        {
+            sync_file_range(m_file, syncedSize, fileSize() - syncedSize, SYNC_FILE_RANGE_WRITE);
+        }
+#endif
+
+        if (fileSize() > m_checkpointSize)
+        {
+            size_t liveSize = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_container->structureMutex());
+                liveSize = m_container->dataSize();
+            }
+
+            const off_t checkpointSize = static_cast<off_t>(liveSize) * 2 + CheckpointSize;
+            if (fileSize() > checkpointSize)
+            {
+                return checkpoint();
+            }
+            m_checkpointSize = checkpointSize;
+        }
+        return true;
+    }
+
+    void run()
+    {
+        auto lastSync = std::chrono::steady_clock::now();
+        bool isRunning = true;
+
+        while (isRunning)
+        {
+            std::vector<std::pair<time_s64, time_s64>> ranges;
+            value_u64 requestCount = 0;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait_for(lock, m_commitInterval, [this]() {
+                    return !m_isRunning || m_requestCount > m_commitCount;
+                });
+                isRunning = m_isRunning;
+                requestCount = m_requestCount;
+                ranges.swap(m_ranges);
+            }
+
+            if (!isFailed())
+            {
+                const auto now = std::chrono::steady_clock::now();
+                const bool isSync = m_syncPolicy == TimeSeriesSyncPolicy::Always ||
+                                    (m_syncPolicy == TimeSeriesSyncPolicy::Interval &&
+                                     (now - lastSync >= m_syncInterval || !isRunning || requestCount > m_commitCount));
+                if (isSync)
+                {
+                    lastSync = now;
+                }
+                if (!commit(ranges, isSync))
+                {
+                    m_isFailed.store(true, std::memory_order_release);
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_commitCount = requestCount;
+            }
+            m_commitCondition.notify_all();
+        }
+    }
+
+    TimeSeriesDataContainer<BlockSize, Compress>* m_container;
+    std::string m_path;
+    int m_file;
+    bool m_isDirect;
+    bool m_isWriteFailed;
+    value_u8* m_buffer;
+    size_t m_bufferSize;
+    off_t m_bufferOffset;
+    off_t m_checkpointSize;
+    time_s64 m_loggedTime;
+    value_u64 m_loggedExtent;
+    std::vector<value_u8> m_payload;
+
+    std::chrono::milliseconds m_commitInterval;
+    std::chrono::milliseconds m_syncInterval;
+    TimeSeriesSyncPolicy m_syncPolicy;
+
+    bool m_isRunning;
+    std::atomic<bool> m_isFailed;
+    value_u64 m_requestCount;
+    value_u64 m_commitCount;
+    std::vector<std::pair<time_s64, time_s64>> m_ranges;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::condition_variable m_commitCondition;
+    std::thread m_thread;
+};
+
+} // namespace TimeSeries
+
+#endif // TIME_SERIES_WRITE_AHEAD_LOG_H
@@ -20,11 +20,24 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <csignal>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
 #include <timeseriesarray.h>
+#include <timeseriescrossquery.h>
+#include <timeseriesmulticolumnarray.h>
+#include <timeseriesqueryexecutor.h>
+#include <timeseriesshardedingest.h>
 
 using TimeSeries::TimeSeriesArray;
 
@@ -59,7 +72,18 @@ struct TestResult
     double durationWrite;
     double durationRead;
     double compressedRatio;
+    double coldRatio;
+    double durationRecompress;
     double durationReadRange;
+    double durationReadAhead;
+    double durationVertices;
+    double durationReadCached;
+    double durationReadMerge;
+    double durationWriteLog;
+    double durationReadShared;
+    double durationRefreshShared;
+    double durationSubscribe;
+    double durationSnapshot;
     std::string error;
 };
 
@@ -227,43 +251,1564 @@ TestResult testReadAndWrite(TestData &data)
                                    std::chrono::steady_clock::now() - durationStart).count();
     }
 
+    // Test reading timeseries data with blocks decoded ahead on a helper thread
+    {
+        const auto durationStart = std::chrono::steady_clock::now();
+        TimeSeries::time_s64 time = timeStart;
+        int index = 0;
+
+        for (auto iter = array.prefetchIter(0, -1, true); iter.isValid(); iter.next())
+        {
+            if (iter.time() != time || iter.value() != convert(data.dataType, data.values[index]))
+            {
+                std::ostringstream error;
+                error << "Read ahead mismatch at index=" << index << "  " << iter.time() << "," << iter.value();
+                result.error = error.str();
+                result.isSuccess = false;
+                break;
+            }
+
+            time += timeStep;
+            index++;
+        }
+
+        if (result.isSuccess && index != data.valueCount) {
+            result.error = "Read ahead invalid count";
+            result.isSuccess = false;
+        }
+
+        result.durationReadAhead = std::chrono::duration<double>(
+                                   std::chrono::steady_clock::now() - durationStart).count();
+    }
+
+    // Test reading recent window repeatedly through block cache
+    {
+        const int windowSize = std::min(262144, data.valueCount);
+        const int windowIndex = data.valueCount - windowSize;
+        const TimeSeries::time_s64 windowTime = timeStart + windowIndex * timeStep;
+        array.enableBlockCache(64);
+
+        const auto durationStart = std::chrono::steady_clock::now();
+
+        for (int pass = 0; result.isSuccess && pass < data.valueCount / windowSize; ++pass)
+        {
+            TimeSeries::time_s64 time = windowTime;
+            int index = windowIndex;
+
+            for (const auto& iter : array.range(windowTime))
+            {
+                if (iter.time() != time ||
+                    iter.value() != convert(data.dataType, data.values[index]))
+                {
+                    std::ostringstream error;
+                    error << "Cached mismatch at index=" << index;
+                    result.error = error.str();
+                    result.isSuccess = false;
+                    break;
+                }
+
+                time += timeStep;
+                index++;
+            }
+        }
+
+        result.durationReadCached = std::chrono::duration<double>(
+                                    std::chrono::steady_clock::now() - durationStart).count();
+        array.enableBlockCache(0);
+    }
+
+    // Test reading timeseries data through inner join with itself
+    {
+        const auto durationStart = std::chrono::steady_clock::now();
+        const TimeSeriesArray<65536, Compress>* arrays[] = { &array, &array };
+        TimeSeries::time_s64 time = timeStart;
+        int index = 0;
+
+        for (auto iter = TimeSeriesArray<65536, Compress>::merge(arrays, 2, TimeSeries::TimeSeriesJoin::Inner);
+             iter.isValid(); iter.next())
+        {
+            const double expectedValue = convert(data.dataType, data.values[index]);
+
+            if (iter.time() != time || iter.value(0) != expectedValue || iter.value(1) != expectedValue)
+            {
+                std::ostringstream error;
+                error << "Merge mismatch at index=" << index;
+                result.error = error.str();
+                result.isSuccess = false;
+                break;
+            }
+
+            time += timeStep;
+            index++;
+        }
+
+        if (result.isSuccess && index != data.valueCount) {
+            result.error = "Merge invalid indexing";
+            result.isSuccess = false;
+        }
+
+        result.durationReadMerge = std::chrono::duration<double>(
+                                   std::chrono::steady_clock::now() - durationStart).count();
+    }
+
+    // Test exporting timeseries data as vertices
+    {
+        const auto durationStart = std::chrono::steady_clock::now();
+        const int windowSize = 65536;
+        float* vertices = new float[windowSize * 2];
+        int index = 0;
+
+        while (result.isSuccess && index < data.valueCount)
+        {
+            const TimeSeries::time_s64 beginTime = timeStart + index * timeStep;
+            const TimeSeries::time_s64 endTime = beginTime + (windowSize - 1) * timeStep;
+            const int count = array.emitVertices(beginTime, endTime, beginTime, 1.0f / timeStep,
+                                                 0.0, 1.0f, vertices, windowSize);
+
+            for (int vertex = 0; vertex < count; ++vertex, ++index)
+            {
+                const float expectedValue = static_cast<float>(
+                                            convert(data.dataType, data.values[index]));
+
+                if (vertices[vertex * 2] != static_cast<float>(vertex) ||
+                    vertices[vertex * 2 + 1] != expectedValue)
+                {
+                    std::ostringstream error;
+                    error << "Vertex mismatch at index=" << index << "  "
+                          << vertices[vertex * 2] << "," << vertices[vertex * 2 + 1] << "!="
+                          << vertex << "," << expectedValue;
+                    result.error = error.str();
+                    result.isSuccess = false;
+                    break;
+                }
+            }
+
+            if (count == 0)
+            {
+                break;
+            }
+        }
+
+        if (result.isSuccess && index != data.valueCount) {
+            result.error = "Vertex invalid indexing";
+            result.isSuccess = false;
+        }
+
+        if (result.isSuccess)
+        {
+            const int expectedCount = std::min(windowSize, data.valueCount);
+            const int count = array.emitVertices(timeStart, -1, timeStart, 1.0f / timeStep,
+                                                 0.0, 1.0f, vertices, windowSize);
+            const int bucketCount = array.emitVertices(timeStart, -1, timeStart, 1.0f / timeStep,
+                                                       0.0, 1.0f, vertices, windowSize, timeStep * 1024);
+            if (count != expectedCount || (data.valueCount > 2048 && bucketCount < 2))
+            {
+                result.error = "Vertex unbounded end time mismatch";
+                result.isSuccess = false;
+            }
+        }
+
+        delete[] vertices;
+        result.durationVertices = std::chrono::duration<double>(
+                                  std::chrono::steady_clock::now() - durationStart).count();
+    }
+
+    // Test reading timeseries data through shared memory
+    {
+        const char* sharedName = "/timeseriesarray_test";
+        TimeSeries::TimeSeriesSharedMemoryReader<65536, Compress> reader;
+
+        if (!array.enableSharedMemory(sharedName, 64) || !reader.attach(sharedName))
+        {
+            result.error = "Shared memory attach failed";
+            result.isSuccess = false;
+        }
+
+        const auto durationStart = std::chrono::steady_clock::now();
+        reader.refresh();
+        const double durationRefresh = std::chrono::duration<double>(
+                                       std::chrono::steady_clock::now() - durationStart).count();
+        auto iter = reader.iter();
+        TimeSeries::time_s64 time = iter.isValid() ? iter.time() : timeStart;
+        const int firstIndex = static_cast<int>((time - timeStart) / timeStep);
+        int index = firstIndex;
+
+        for (; result.isSuccess && iter.isValid(); iter.next(), ++index)
+        {
+            const double expectedValue = convert(data.dataType, data.values[index]);
+
+            if (iter.time() != time || iter.value() != expectedValue)
+            {
+                std::ostringstream error;
+                error << "Shared mismatch at index=" << index << "  " << iter.time() << ","
+                      << iter.value() << "!=" << time << "," << expectedValue;
+                result.error = error.str();
+                result.isSuccess = false;
+            }
+            time += timeStep;
+        }
+
+        if (result.isSuccess && index != data.valueCount) {
+            result.error = "Shared invalid count";
+            result.isSuccess = false;
+        }
+
+        result.durationReadShared = std::chrono::duration<double>(
+                                    std::chrono::steady_clock::now() - durationStart).count() *
+                                    data.valueCount / std::max(1, index - firstIndex);
+        result.durationRefreshShared = durationRefresh * data.valueCount / std::max(1, index - firstIndex);
+        array.disableSharedMemory();
+    }
+
+    // Test writing nanosecond timestamps with gaps wider than 32 bits
+    {
+        const int wideCount = std::min(1 << 20, data.valueCount);
+        const TimeSeries::time_s64 wideGap = 1LL << 40;
+        TimeSeriesArray<65536, Compress> wideArray(std::chrono::hours(24 * 365),
+                                                   TimeSeries::TimeSeriesTimeUnit::Nanoseconds);
+        TimeSeries::time_s64 time = timeStart;
+
+        for (int index = 0; index < wideCount; ++index)
+        {
+            wideArray.append(time, convert(data.dataType, data.values[index]));
+            time += index % 1000 == 999 ? wideGap : timeStep;
+        }
+
+        time = timeStart;
+        int index = 0;
+
+        for (auto iter = wideArray.iter(); result.isSuccess && iter.isValid(); iter.next(), ++index)
+        {
+            if (iter.time() != time || iter.value() != convert(data.dataType, data.values[index]))
+            {
+                std::ostringstream error;
+                error << "Wide time mismatch at index=" << index << "  " << iter.time() << "!=" << time;
+                result.error = error.str();
+                result.isSuccess = false;
+            }
+            time += index % 1000 == 999 ? wideGap : timeStep;
+        }
+
+        if (result.isSuccess && index != wideCount) {
+            result.error = "Wide time invalid count";
+            result.isSuccess = false;
+        }
+    }
+
+    // Test reading timeseries data through a snapshot
+    {
+        const auto durationStart = std::chrono::steady_clock::now();
+        auto snapshot = array.snapshot();
+        TimeSeries::time_s64 time = timeStart;
+        int index = 0;
+
+        snapshot.forEach([&](TimeSeries::time_s64 sampleTime, double value) {
+            if (result.isSuccess && (sampleTime != time || value != convert(data.dataType, data.values[index])))
+            {
+                std::ostringstream error;
+                error << "Snapshot mismatch at index=" << index << "  " << sampleTime << "," << value;
+                result.error = error.str();
+                result.isSuccess = false;
+            }
+            time += timeStep;
+            ++index;
+        });
+
+        if (result.isSuccess && (index != data.valueCount || snapshot.sampleCount() != static_cast<size_t>(index)))
+        {
+            result.error = "Snapshot invalid count";
+            result.isSuccess = false;
+        }
+
+        result.durationSnapshot = std::chrono::duration<double>(
+                                  std::chrono::steady_clock::now() - durationStart).count();
+    }
+
+    // Test paging timeseries data by sample ordinal
+    {
+        const int pageSize = 1000;
+        std::vector<TimeSeries::time_s64> times(pageSize);
+        std::vector<double> values(pageSize);
+
+        if (array.count() != static_cast<size_t>(data.valueCount) ||
+            array.count(timeStart + timeStep * 10, timeStart + timeStep * 19) != 10)
+        {
+            result.error = "Paging invalid count";
+            result.isSuccess = false;
+        }
+
+        for (int page = 0; result.isSuccess && page < 100; ++page)
+        {
+            const int ordinal = static_cast<int>((static_cast<long long>(page) * 7919 * pageSize) % data.valueCount);
+            const int count = array.read(ordinal, times.data(), values.data(), pageSize);
+
+            for (int index = 0; result.isSuccess && index < count; ++index)
+            {
+                if (times[index] != timeStart + timeStep * (ordinal + index) ||
+                    values[index] != convert(data.dataType, data.values[ordinal + index]))
+                {
+                    std::ostringstream error;
+                    error << "Paging mismatch at ordinal=" << (ordinal + index);
+                    result.error = error.str();
+                    result.isSuccess = false;
+                }
+            }
+
+            if (result.isSuccess && count != std::min(pageSize, data.valueCount - ordinal))
+            {
+                result.error = "Paging invalid page size";
+                result.isSuccess = false;
+            }
+        }
+    }
+
+    // Test streaming timeseries data to a subscriber while writing
+    {
+        const int streamCount = std::min(1 << 23, data.valueCount);
+        TimeSeriesArray<65536, Compress> streamArray(timeStep * data.valueCount);
+        auto subscription = streamArray.subscribe(timeStart, 4096);
+        std::string streamError;
+        int index = 0;
+
+        const auto durationStart = std::chrono::steady_clock::now();
+        std::thread consumer([&]() {
+            while (streamError.empty() && index < streamCount)
+            {
+                const int count = subscription.poll();
+                if (count == 0)
+                {
+                    subscription.waitFor(100);
+                    continue;
+                }
+
+                for (int sample = 0; sample < count; ++sample, ++index)
+                {
+                    const TimeSeries::time_s64 expectedTime = timeStart + index * timeStep;
+                    const double expectedValue = convert(data.dataType, data.values[index]);
+
+                    if (subscription.times()[sample] != expectedTime || subscription.values()[sample] != expectedValue)
+                    {
+                        std::ostringstream error;
+                        error << "Stream mismatch at index=" << index << "  " << subscription.times()[sample]
+                              << "," << subscription.values()[sample] << "!=" << expectedTime << ","
+                              << expectedValue;
+                        streamError = error.str();
+                        break;
+                    }
+                }
+            }
+        });
+
+        TimeSeries::time_s64 time = timeStart;
+        for (int index = 0; index < streamCount; ++index)
+        {
+            streamArray.append(time, convert(data.dataType, data.values[index]));
+            time += timeStep;
+        }
+        consumer.join();
+
+        result.durationSubscribe = std::chrono::duration<double>(
+                                   std::chrono::steady_clock::now() - durationStart).count() *
+                                   data.valueCount / streamCount;
+
+        if (result.isSuccess && !streamError.empty())
+        {
+            result.error = streamError;
+            result.isSuccess = false;
+        }
+    }
+
+    // Test writing timeseries data through write-ahead log and replaying it
+    {
+        const char* logPath = "timeseriesarray_test.wal";
+        const int logCount = std::min(1 << 23, data.valueCount);
+        std::remove(logPath);
+
+        {
+            TimeSeriesArray<65536, Compress> logArray(timeStep * data.valueCount);
+            logArray.enableWriteAheadLog(logPath, 10, TimeSeries::TimeSeriesSyncPolicy::Interval);
+            TimeSeries::time_s64 time = timeStart;
+
+            const auto durationStart = std::chrono::steady_clock::now();
+            for (int index = 0; index < logCount; ++index)
+            {
+                logArray.append(time, convert(data.dataType, data.values[index]));
+                time += timeStep;
+            }
+            if (!logArray.flushWriteAheadLog())
+            {
+                result.error = "Write-ahead log flush failed";
+                result.isSuccess = false;
+            }
+            result.durationWriteLog = std::chrono::duration<double>(
+                                      std::chrono::steady_clock::now() - durationStart).count() *
+                                      data.valueCount / logCount;
+        }
+
+        TimeSeriesArray<65536, Compress> replayArray(timeStep * data.valueCount);
+        if (!replayArray.enableWriteAheadLog(logPath))
+        {
+            result.error = "Write-ahead log replay failed";
+            result.isSuccess = false;
+        }
+        replayArray.disableWriteAheadLog();
+
+        auto iter = replayArray.iter();
+        int index = 0;
+
+        for (; result.isSuccess && iter.isValid(); iter.next(), ++index)
+        {
+            const TimeSeries::time_s64 expectedTime = timeStart + index * timeStep;
+            const double expectedValue = convert(data.dataType, data.values[index]);
+
+            if (iter.time() != expectedTime || iter.value() != expectedValue)
+            {
+                std::ostringstream error;
+                error << "Replay mismatch at index=" << index << "  " << iter.time() << ","
+                      << iter.value() << "!=" << expectedTime << "," << expectedValue;
+                result.error = error.str();
+                result.isSuccess = false;
+            }
+        }
+
+        if (result.isSuccess && index != logCount) {
+            result.error = "Replay invalid count";
+            result.isSuccess = false;
+        }
+
+        {
+            const TimeSeries::value_u32 corruptHeader[3] = { 0xFFFFFFF0u, 0x10000000u, 0 };
+            std::ofstream logFile(logPath, std::ios::binary | std::ios::app);
+            logFile.write(reinterpret_cast<const char*>(corruptHeader), sizeof(corruptHeader));
+        }
+
+        TimeSeriesArray<65536, Compress> corruptArray(timeStep * data.valueCount);
+        if (result.isSuccess && (!corruptArray.enableWriteAheadLog(logPath) ||
+                                 corruptArray.count() != static_cast<size_t>(logCount)))
+        {
+            result.error = "Write-ahead log replay accepted corrupt batch";
+            result.isSuccess = false;
+        }
+        corruptArray.disableWriteAheadLog();
+
+        std::remove(logPath);
+    }
+
+    // Test recompressing aged blocks into the cold tier and reading them back
+    {
+        const auto durationStart = std::chrono::steady_clock::now();
+        array.recompress(0);
+        result.durationRecompress = std::chrono::duration<double>(
+                                    std::chrono::steady_clock::now() - durationStart).count();
+        result.coldRatio = array.dataSize() / (16.0 * data.valueCount);
+
+        TimeSeries::time_s64 time = timeStart;
+        int index = 0;
+
+        for (auto iter = array.iter(); result.isSuccess && iter.isValid(); iter.next(), ++index)
+        {
+            if (iter.time() != time || iter.value() != convert(data.dataType, data.values[index]))
+            {
+                std::ostringstream error;
+                error << "Cold tier mismatch at index=" << index << "  " << iter.time() << "," << iter.value();
+                result.error = error.str();
+                result.isSuccess = false;
+            }
+            time += timeStep;
+        }
+
+        if (result.isSuccess && (index != data.valueCount ||
+                                 array.aggregate().count != static_cast<size_t>(data.valueCount)))
+        {
+            result.error = "Cold tier invalid count";
+            result.isSuccess = false;
+        }
+    }
+
     return result;
 }
 
-template<bool Compress>
-bool test(DataType dataType, const double *values, int valueCount)
+template<bool Compress>
+bool test(DataType dataType, const double *values, int valueCount)
+{
+    TestData testData;
+    testData.dataType = dataType;
+    testData.timeStep = 155;
+    testData.values = values;
+    testData.valueCount = valueCount;
+
+    const double timeScale = (valueCount * 16.0) / (1024 * 1024);
+    std::cout << "Compress        : " << (Compress ? "true" : "false") << std::endl;
+    auto result = testReadAndWrite<Compress>(testData);
+
+    std::cout
+        << "Time write      : " << result.durationWrite << "s   Speed : "
+        << (timeScale * (1.0 / result.durationWrite)) << "MB/s"
+        << std::endl
+
+        << "Time write WAL  : " << result.durationWriteLog << "s   Speed : "
+        << (timeScale * (1.0 / result.durationWriteLog)) << "MB/s"
+        << std::endl
+
+        << "Time read       : " << result.durationRead
+        << "s   Speed : " << (timeScale * (1.0 / result.durationRead)) << "MB/s"
+        << std::endl
+
+        << "Time read range : " << result.durationReadRange
+        << "s   Speed : " << (timeScale * (1.0 / result.durationReadRange)) << "MB/s"
+        << std::endl
+
+        << "Time read ahead : " << result.durationReadAhead
+        << "s   Speed : " << (timeScale * (1.0 / result.durationReadAhead)) << "MB/s"
+        << std::endl
+
+        << "Time snapshot   : " << result.durationSnapshot
+        << "s   Speed : " << (timeScale * (1.0 / result.durationSnapshot)) << "MB/s"
+        << std::endl
+
+        << "Time subscribe  : " << result.durationSubscribe
+        << "s   Speed : " << (timeScale * (1.0 / result.durationSubscribe)) << "MB/s"
+        << std::endl
+
+        << "Time read shared: " << result.durationReadShared
+        << "s   Speed : " << (timeScale * (1.0 / result.durationReadShared)) << "MB/s   refresh "
+        << result.durationRefreshShared << "s" << std::endl
+
+        << "Time read merge : " << result.durationReadMerge
+        << "s   Speed : " << (timeScale * (1.0 / result.durationReadMerge)) << "MB/s"
+        << std::endl
+
+        << "Time vertices   : " << result.durationVertices
+        << "s   Speed : " << (timeScale * (1.0 / result.durationVertices)) << "MB/s"
+        << std::endl
+
+        << "Time read cached: " << result.durationReadCached
+        << "s   Speed : " << (timeScale * (1.0 / result.durationReadCached)) << "MB/s"
+        << std::endl
+
+        << "Time cold tier  : " << result.durationRecompress
+        << "s   Speed : " << (timeScale * (1.0 / result.durationRecompress)) << "MB/s"
+        << std::endl
+
+        << "Compressed size : " << (result.compressedRatio * 100.0) << "% of original data"
+        << std::endl
+
+        << "Cold size       : " << (result.coldRatio * 100.0) << "% of original data"
+        << std::endl;
+
+    if (!result.isSuccess) {
+        std::cout << "Failed: " << result.error << std::endl;
+    }
+
+    return result.isSuccess;
+}
+
+bool testBlockCache()
+{
+    TimeSeries::TimeSeriesArray<65536, true> array(1000000);
+    array.enableBlockCache(4);
+
+    int counts[2] = { 0, 0 };
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (int index = pass * 10; index < pass * 10 + 10; ++index)
+        {
+            array.append(1000 + index * 10, 5.0);
+        }
+        for (auto iter = array.iter(); iter.isValid(); iter.next())
+        {
+            ++counts[pass];
+        }
+    }
+
+    std::cout << "Block cache     : " << counts[0] << " then " << counts[1] << " samples" << std::endl;
+
+    if (counts[0] != 10 || counts[1] != 20)
+    {
+        std::cout << "Failed: Block cache returned stale run" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool testWriteAheadLog()
+{
+    const char* logPath = "timeseriesarray_retention.wal";
+    const int sampleCount = 1 << 21;
+    std::remove(logPath);
+
+    TimeSeries::TimeSeriesArray<1024, false> array(100000);
+    bool isSuccess = array.enableWriteAheadLog(logPath, 1, TimeSeries::TimeSeriesSyncPolicy::Interval, 50);
+    for (int index = 0; index < sampleCount; ++index)
+    {
+        array.append(1000 + index, index * 0.5);
+    }
+    isSuccess &= array.flushWriteAheadLog();
+    array.disableWriteAheadLog();
+
+    std::ifstream logFile(logPath, std::ios::binary | std::ios::ate);
+    const long long logSize = logFile.tellg();
+    logFile.close();
+
+    TimeSeries::TimeSeriesArray<1024, false> replayArray(100000);
+    isSuccess &= replayArray.enableWriteAheadLog(logPath);
+    replayArray.disableWriteAheadLog();
+    isSuccess &= replayArray.count() == array.count() &&
+                 replayArray.aggregate().max == (sampleCount - 1) * 0.5;
+    std::remove(logPath);
+
+    rlimit fileLimit;
+    getrlimit(RLIMIT_FSIZE, &fileLimit);
+    rlimit smallLimit = fileLimit;
+    smallLimit.rlim_cur = 1 << 20;
+    const auto signalHandler = std::signal(SIGXFSZ, SIG_IGN);
+    setrlimit(RLIMIT_FSIZE, &smallLimit);
+
+    bool isFullDetected = false;
+    {
+        TimeSeries::TimeSeriesArray<1024, false> fullArray(sampleCount);
+        if (fullArray.enableWriteAheadLog(logPath))
+        {
+            for (int index = 0; index < sampleCount / 8; ++index)
+            {
+                fullArray.append(1000 + index, index * 0.5);
+            }
+            isFullDetected = !fullArray.flushWriteAheadLog();
+        }
+    }
+
+    setrlimit(RLIMIT_FSIZE, &fileLimit);
+    std::signal(SIGXFSZ, signalHandler);
+    std::remove(logPath);
+
+    std::cout << "Write-ahead log : " << logSize << " bytes for " << array.count() << " live of "
+              << sampleCount << " samples" << std::endl;
+
+    if (!isSuccess || logSize > (1 << 24) + 4 * static_cast<long long>(array.dataSize()))
+    {
+        std::cout << "Failed: Write-ahead log not truncated to retention" << std::endl;
+        return false;
+    }
+    if (!isFullDetected)
+    {
+        std::cout << "Failed: Write-ahead log write error not reported" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool testColdTier(const double *values, int valueCount)
+{
+    const TimeSeries::time_s64 dayMillis = 24 * 3600 * 1000;
+    const TimeSeries::time_s64 hourMillis = 3600 * 1000;
+    const TimeSeries::time_s64 timeStart = 55556666;
+    const TimeSeries::time_s64 timeStep = 1000;
+    const int sampleCount = std::min(static_cast<int>(30 * dayMillis / timeStep), valueCount);
+    const TimeSeries::time_s64 timeEnd = timeStart + (sampleCount - 1) * timeStep;
+
+    TimeSeries::TimeSeriesArray<65536, true> hotArray(30 * dayMillis);
+    TimeSeries::TimeSeriesArray<65536, true> coldArray(30 * dayMillis);
+    coldArray.enableColdTier(hourMillis, 1);
+
+    for (int index = 0; index < sampleCount; ++index)
+    {
+        hotArray.append(timeStart + index * timeStep, values[index]);
+        coldArray.append(timeStart + index * timeStep, values[index]);
+    }
+    coldArray.disableColdTier();
+    coldArray.recompress(hourMillis);
+
+    double hotDuration = 0.0;
+    double coldDuration = 0.0;
+    bool isSuccess = true;
+    for (int repeat = 0; repeat < 64; ++repeat)
+    {
+        auto durationStart = std::chrono::steady_clock::now();
+        const TimeSeries::TimeSeriesAggregate hotAggregate = hotArray.aggregate(timeEnd - hourMillis, timeEnd);
+        hotDuration += std::chrono::duration<double>(std::chrono::steady_clock::now() - durationStart).count();
+
+        durationStart = std::chrono::steady_clock::now();
+        const TimeSeries::TimeSeriesAggregate coldAggregate = coldArray.aggregate(timeEnd - hourMillis, timeEnd);
+        coldDuration += std::chrono::duration<double>(std::chrono::steady_clock::now() - durationStart).count();
+
+        isSuccess &= hotAggregate.count == coldAggregate.count && hotAggregate.sum == coldAggregate.sum;
+    }
+
+    int index = 0;
+    for (auto iter = coldArray.iter(); isSuccess && iter.isValid(); iter.next(), ++index)
+    {
+        isSuccess &= iter.time() == timeStart + index * timeStep && iter.value() == values[index];
+    }
+    isSuccess &= index == sampleCount;
+
+    const size_t hotSize = hotArray.stats().memorySize;
+    const size_t coldSize = coldArray.stats().memorySize;
+    std::cout
+        << "Cold tier 30d   : " << sampleCount << " samples, memory " << hotSize << " -> " << coldSize << " bytes ("
+        << (100.0 * coldSize / hotSize) << "%), hot hour aggregate " << (hotDuration * 1e6 / 64) << "us vs "
+        << (coldDuration * 1e6 / 64) << "us" << std::endl;
+
+    if (!isSuccess || coldSize >= hotSize)
+    {
+        std::cout << "Failed: Cold tier retention" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+template<int BlockSize>
+bool testRunLength()
+{
+    const int runCounts[3] = { 200000, 1, 150000 };
+    const double runValues[3] = { 7.25, -1.5, -3.5 };
+    const TimeSeries::time_s64 timeStart = 1000;
+    const TimeSeries::time_s64 timeStep = 10;
+
+    TimeSeries::TimeSeriesArray<BlockSize, true> array(timeStep * 1000000);
+    std::vector<TimeSeries::time_s64> times;
+    std::vector<double> values;
+
+    for (int run = 0; run < 3; ++run)
+    {
+        for (int index = 0; index < runCounts[run]; ++index)
+        {
+            times.push_back(timeStart + times.size() * timeStep);
+            values.push_back(runValues[run]);
+            array.append(times.back(), values.back());
+        }
+    }
+
+    const int valueCount = static_cast<int>(values.size());
+    int iterCount = 0;
+    for (auto iter = array.iter(); iter.isValid() && iterCount <= valueCount; iter.next(), ++iterCount)
+    {
+        if (iterCount == valueCount || iter.time() != times[iterCount] || iter.value() != values[iterCount])
+        {
+            std::cout << "Failed: Run length iterator mismatch at index=" << iterCount << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<TimeSeries::time_s64> readTimes(valueCount);
+    std::vector<double> readValues(valueCount);
+    const int readOffset = 65530;
+    const int readCount = array.read(readOffset, readTimes.data(), readValues.data(), valueCount);
+    for (int index = 0; index < readCount; ++index)
+    {
+        if (readTimes[index] != times[readOffset + index] || readValues[index] != values[readOffset + index])
+        {
+            std::cout << "Failed: Run length read mismatch at index=" << readOffset + index << std::endl;
+            return false;
+        }
+    }
+
+    const TimeSeries::TimeSeriesAggregate aggregate = array.aggregate();
+    const TimeSeries::TimeSeriesAggregate partial = array.aggregate(times[100000], times[250000]);
+
+    std::cout << "Run length      : " << valueCount << " samples in " << array.dataSize()
+              << " bytes, block size " << BlockSize << std::endl;
+
+    if (iterCount != valueCount || readCount != valueCount - readOffset ||
+        array.count() != static_cast<size_t>(valueCount) ||
+        array.dataSize() >= static_cast<size_t>(valueCount) ||
+        aggregate.count != static_cast<size_t>(valueCount) ||
+        aggregate.sum != 7.25 * 200000 - 1.5 - 3.5 * 150000 ||
+        aggregate.min != -3.5 || aggregate.max != 7.25 ||
+        partial.count != 150001 || partial.sum != 7.25 * 100000 - 1.5 - 3.5 * 50000)
+    {
+        std::cout << "Failed: Run length count, size or aggregate mismatch" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+template<class Pipeline>
+bool checkPipeline(const char* name, const Pipeline& pipeline, const std::vector<double>& expectedValues)
+{
+    std::vector<double> values;
+    pipeline.forEach([&](TimeSeries::time_s64, double value) {
+        values.push_back(value);
+    });
+
+    if (values != expectedValues)
+    {
+        std::cout << "Failed: Pipeline " << name << " mismatch" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testPipeline()
+{
+    using TimeSeries::TimeSeriesRolling;
+
+    const double values[5] = { 4.0, 8.0, 2.0, 6.0, 10.0 };
+    TimeSeries::TimeSeriesArray<65536, true> array(1000000);
+    for (int index = 0; index < 5; ++index)
+    {
+        array.append(1000 + index * 1000, values[index]);
+    }
+
+    const auto range = array.range();
+    bool isSuccess = true;
+
+    isSuccess &= checkPipeline("rate", range | TimeSeries::rate(), { 4.0, 2.0, 4.0, 4.0 });
+    isSuccess &= checkPipeline("derivative", range | TimeSeries::derivative(), { 4.0, -6.0, 4.0, 4.0 });
+    isSuccess &= checkPipeline("ewma", range | TimeSeries::ewma(0.5), { 4.0, 6.0, 4.0, 5.0, 7.5 });
+    isSuccess &= checkPipeline("rolling min", range | TimeSeries::rolling(2000, TimeSeriesRolling::Min),
+                               { 4.0, 4.0, 2.0, 2.0, 6.0 });
+    isSuccess &= checkPipeline("rolling max", range | TimeSeries::rolling(2000, TimeSeriesRolling::Max),
+                               { 4.0, 8.0, 8.0, 6.0, 10.0 });
+    isSuccess &= checkPipeline("rolling sum", range | TimeSeries::rolling(2000, TimeSeriesRolling::Sum),
+                               { 4.0, 12.0, 10.0, 8.0, 16.0 });
+    isSuccess &= checkPipeline("rolling mean", range | TimeSeries::rolling(2000, TimeSeriesRolling::Mean),
+                               { 4.0, 6.0, 5.0, 4.0, 8.0 });
+    isSuccess &= checkPipeline("rate | rolling sum",
+                               range | TimeSeries::rate() | TimeSeries::rolling(2000, TimeSeriesRolling::Sum),
+                               { 4.0, 6.0, 6.0, 8.0 });
+    isSuccess &= checkPipeline("ewma | derivative",
+                               range | TimeSeries::ewma(0.5) | TimeSeries::derivative(),
+                               { 2.0, -2.0, 1.0, 2.5 });
+    isSuccess &= checkPipeline("rolling growth", range | TimeSeries::rolling(5000, TimeSeriesRolling::Max, 1),
+                               { 4.0, 8.0, 8.0, 8.0, 10.0 });
+
+    TimeSeries::TimeSeriesArray<65536, true> seconds(1000000, TimeSeries::TimeSeriesTimeUnit::Seconds);
+    for (int index = 0; index < 5; ++index)
+    {
+        seconds.append(1 + index * 2, values[index]);
+    }
+
+    isSuccess &= checkPipeline("seconds rate", seconds.range() | TimeSeries::rate(), { 2.0, 1.0, 2.0, 2.0 });
+    isSuccess &= checkPipeline("seconds rate per minute",
+                               seconds.range() | TimeSeries::rate(std::chrono::minutes(1)),
+                               { 120.0, 60.0, 120.0, 120.0 });
+    isSuccess &= checkPipeline("seconds ewma | derivative",
+                               seconds.range() | TimeSeries::ewma(0.5) | TimeSeries::derivative(),
+                               { 1.0, -1.0, 0.5, 1.25 });
+
+    static_assert(!TimeSeries::TimeSeriesIsPipelineStage<double>::value, "double is not a pipeline stage");
+
+    std::cout << "Pipeline        : " << (isSuccess ? "rate, ewma, rolling and composition match" : "mismatch")
+              << std::endl;
+    return isSuccess;
+}
+
+bool testErrorBound(const double *values, int valueCount)
+{
+    using TimeSeries::TimeSeriesErrorBound;
+
+    const int sampleCount = std::min(1 << 20, valueCount);
+    const TimeSeriesErrorBound errorBounds[5] = { TimeSeriesErrorBound::None,
+                                                  TimeSeriesErrorBound::Absolute, TimeSeriesErrorBound::Absolute,
+                                                  TimeSeriesErrorBound::Relative, TimeSeriesErrorBound::Relative };
+    const double bounds[5] = { 0.0, 0.5, 1000.0, 1e-3, 1e-9 };
+    bool isSuccess = true;
+
+    for (int mode = 0; mode < 5; ++mode)
+    {
+        TimeSeriesArray<65536, true> array(155 * sampleCount);
+        array.setErrorBound(errorBounds[mode], bounds[mode]);
+        for (int index = 0; index < sampleCount; ++index)
+        {
+            array.append(1000 + index * 155, values[index]);
+        }
+
+        double maxError = 0.0;
+        int index = 0;
+        for (auto iter = array.iter(); iter.isValid() && index < sampleCount; iter.next(), ++index)
+        {
+            const double error = std::fabs(iter.value() - values[index]);
+            maxError = std::max(maxError, errorBounds[mode] == TimeSeriesErrorBound::Relative ?
+                                          error / std::fabs(values[index]) : error);
+        }
+
+        std::cout << "Error bound     : mode " << mode << " bound " << bounds[mode] << " max error " << maxError
+                  << " size " << 100.0 * array.dataSize() / (16.0 * sampleCount) << "%" << std::endl;
+
+        const TimeSeries::TimeSeriesArrayStats stats = array.stats();
+        const double statsError = errorBounds[mode] == TimeSeriesErrorBound::Relative ?
+                                  stats.maxRelativeError : stats.maxAbsoluteError;
+
+        if (index != sampleCount || maxError > bounds[mode] || statsError > bounds[mode])
+        {
+            std::cout << "Failed: Quantized values exceed error bound" << std::endl;
+            isSuccess = false;
+        }
+    }
+
+    return isSuccess;
+}
+
+template<bool Compress>
+bool checkBlockDirectory(const TimeSeries::TimeSeriesDataContainer<1024, Compress>& container)
+{
+    const int blockCount = container.blockCount();
+    std::vector<TimeSeries::time_s64> probeTimes;
+
+    for (int index = 0; index < blockCount; ++index)
+    {
+        const TimeSeries::TimeSeriesBlockInfo info = container.blockInfo(index);
+        const auto block = container.block(index);
+
+        if (info.beginTime != block->beginTime() || info.endTime != block->endTime() ||
+            info.count != block->count() || info.memorySize != static_cast<int>(block->memorySize()))
+        {
+            std::cout << "Failed: Block directory entry mismatch at block=" << index << std::endl;
+            return false;
+        }
+
+        probeTimes.push_back(info.beginTime - 1);
+        probeTimes.push_back(info.beginTime);
+        probeTimes.push_back(info.beginTime + 1);
+        probeTimes.push_back(info.endTime);
+    }
+    probeTimes.push_back(std::numeric_limits<TimeSeries::time_s64>::max());
+
+    for (const TimeSeries::time_s64 time : probeTimes)
+    {
+        int blockIndex = 0;
+        while (blockIndex + 1 < blockCount && container.block(blockIndex + 1)->beginTime() <= time)
+        {
+            ++blockIndex;
+        }
+
+        if (container.findBlock(time) != blockIndex)
+        {
+            std::cout << "Failed: Block directory findBlock mismatch at time=" << time << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<bool Compress>
+bool testBlockDirectory(const double *values, int valueCount)
+{
+    const int sampleCount = std::min(1 << 15, valueCount);
+    const TimeSeries::time_s64 timeStep = 155;
+    TimeSeries::TimeSeriesDataContainer<1024, Compress> container(timeStep * valueCount);
+    TimeSeries::time_s64 time = 1000;
+
+    for (int index = 0; index < sampleCount; ++index, time += timeStep)
+    {
+        container.append(time, values[index]);
+    }
+    bool isSuccess = checkBlockDirectory(container);
+
+    const int tailIndex = container.blockCount() - 1;
+    const int tailCount = container.block(tailIndex)->count();
+    const size_t openMemorySize = container.block(tailIndex)->memorySize();
+
+    const bool isCompacted = !container.compactIdle(time, timeStep * 2) &&
+                             container.compactIdle(time + timeStep * 2, timeStep * 2);
+    const size_t sealedMemorySize = container.block(tailIndex)->memorySize();
+    isSuccess &= checkBlockDirectory(container);
+
+    container.append(time, 1.0);
+    const bool isSealed = container.block(tailIndex)->isSealed() && sealedMemorySize < openMemorySize &&
+                          container.block(tailIndex)->count() == tailCount &&
+                          container.blockCount() == tailIndex + 2;
+    isSuccess &= checkBlockDirectory(container);
+
+    const TimeSeries::time_s64 firstTime = container.blockInfo(0).beginTime;
+    const size_t memoryBudget = container.stats().memorySize / 3;
+    container.setMemoryBudget(memoryBudget);
+    const size_t evictedMemorySize = container.stats().memorySize;
+    isSuccess &= checkBlockDirectory(container);
+
+    for (int index = 0; index < sampleCount; ++index)
+    {
+        time += timeStep;
+        container.append(time, values[index]);
+    }
+
+    size_t blockMemorySize = 0;
+    for (int index = 0; index + 1 < container.blockCount(); ++index)
+    {
+        blockMemorySize += container.block(index)->memorySize();
+    }
+
+    const bool isBudgeted = evictedMemorySize <= memoryBudget &&
+                            container.stats().memorySize <= memoryBudget &&
+                            blockMemorySize <= memoryBudget &&
+                            container.blockInfo(0).beginTime > firstTime;
+    isSuccess &= checkBlockDirectory(container);
+
+    std::cout << "Block directory : " << container.blockCount() << " blocks, sealed tail "
+              << openMemorySize << " -> " << sealedMemorySize << " bytes, budget "
+              << memoryBudget << " holds " << container.stats().memorySize << " bytes" << std::endl;
+
+    if (!isCompacted || !isSealed || !isBudgeted)
+    {
+        std::cout << "Failed: Block seal or memory budget mismatch" << std::endl;
+        return false;
+    }
+
+    return isSuccess;
+}
+
+bool testShardedIngest(const double *values, int valueCount)
 {
-    TestData testData;
-    testData.dataType = dataType;
-    testData.timeStep = 155;
-    testData.values = values;
-    testData.valueCount = valueCount;
+    const int seriesCount = 4096;
+    const int sampleCount = std::min(1 << 24, valueCount);
+    const int producerCount = std::max(1u, std::thread::hardware_concurrency() / 2);
+    const int shardCount = std::max(1u, std::thread::hardware_concurrency() / 2);
+    const TimeSeries::time_s64 timeStart = 55556666;
+    const TimeSeries::time_s64 timeStep = 155;
 
-    const double timeScale = (valueCount * 16.0) / (1024 * 1024);
-    std::cout << "Compress        : " << (Compress ? "true" : "false") << std::endl;
-    auto result = testReadAndWrite<Compress>(testData);
+    TimeSeries::TimeSeriesShardedIngest<65536, true> ingest(shardCount, timeStep * sampleCount);
+    std::vector<std::vector<double>> latencies(producerCount);
+    std::vector<std::thread> producers;
+
+    const auto durationStart = std::chrono::steady_clock::now();
+    for (int producer = 0; producer < producerCount; ++producer)
+    {
+        producers.emplace_back([&, producer]() {
+            int appendCount = 0;
+            for (int rowIndex = 0; rowIndex * seriesCount < sampleCount; ++rowIndex)
+            {
+                const TimeSeries::time_s64 time = timeStart + rowIndex * timeStep;
+                for (int seriesId = producer; seriesId < seriesCount; seriesId += producerCount)
+                {
+                    const int index = rowIndex * seriesCount + seriesId;
+                    if (index >= sampleCount)
+                    {
+                        break;
+                    }
+
+                    if (appendCount++ % 1024 == 0)
+                    {
+                        const auto appendStart = std::chrono::steady_clock::now();
+                        ingest.append(seriesId, time, values[index]);
+                        latencies[producer].push_back(std::chrono::duration<double, std::nano>(
+                                                      std::chrono::steady_clock::now() - appendStart).count());
+                    }
+                    else
+                    {
+                        ingest.append(seriesId, time, values[index]);
+                    }
+                }
+            }
+        });
+    }
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    ingest.flush();
+
+    const double duration = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - durationStart).count();
+
+    std::vector<double> latency;
+    for (const auto& producerLatencies : latencies)
+    {
+        latency.insert(latency.end(), producerLatencies.begin(), producerLatencies.end());
+    }
+    std::sort(latency.begin(), latency.end());
+
+    size_t ingestedCount = 0;
+    for (int seriesId = 0; seriesId < seriesCount; ++seriesId)
+    {
+        const auto series = ingest.series(seriesId);
+        ingestedCount += series ? series->stats().sampleCount : 0;
+    }
 
     std::cout
-        << "Time write      : " << result.durationWrite << "s   Speed : "
-        << (timeScale * (1.0 / result.durationWrite)) << "MB/s"
-        << std::endl
+        << "Sharded ingest  : " << shardCount << " shards, " << producerCount << " producers, "
+        << seriesCount << " series" << std::endl
+        << "Time write      : " << duration << "s   Speed : "
+        << ((sampleCount * 16.0) / (1024 * 1024) / duration) << "MB/s" << std::endl
+        << "Append latency  : p50 " << latency[latency.size() / 2] << "ns   p99 "
+        << latency[latency.size() * 99 / 100] << "ns   p99.9 " << latency[latency.size() * 999 / 1000] << "ns"
+        << std::endl;
 
-        << "Time read       : " << result.durationRead
-        << "s   Speed : " << (timeScale * (1.0 / result.durationRead)) << "MB/s"
-        << std::endl
+    if (ingestedCount != static_cast<size_t>(sampleCount))
+    {
+        std::cout << "Failed: Sharded ingest count " << ingestedCount << "!=" << sampleCount << std::endl;
+        return false;
+    }
 
-        << "Time read range : " << result.durationReadRange
-        << "s   Speed : " << (timeScale * (1.0 / result.durationReadRange)) << "MB/s"
-        << std::endl
+    return true;
+}
 
-        << "Compressed size : " << (result.compressedRatio * 100.0) << "% of original data"
+bool testMultiColumn(const double *values, int valueCount)
+{
+    const int Columns = 4;
+    const int rowCount = std::min(1 << 23, valueCount / Columns);
+    const TimeSeries::time_s64 timeStart = 55556666;
+    const TimeSeries::time_s64 timeStep = 155;
+
+    TimeSeries::TimeSeriesMultiColumnArray<Columns, 65536> array(timeStep * rowCount);
+
+    const auto durationStart = std::chrono::steady_clock::now();
+    for (int index = 0; index < rowCount; ++index)
+    {
+        array.append(timeStart + index * timeStep, values + index * Columns);
+    }
+    const double durationWrite = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - durationStart).count();
+
+    size_t separateSize = 0;
+    for (int column = 0; column < Columns; ++column)
+    {
+        TimeSeries::TimeSeriesArray<65536, true> columnArray(timeStep * rowCount);
+        for (int index = 0; index < rowCount; ++index)
+        {
+            columnArray.append(timeStart + index * timeStep, values[index * Columns + column]);
+        }
+        separateSize += columnArray.dataSize();
+    }
+
+    const auto readStart = std::chrono::steady_clock::now();
+    int index = 0;
+    bool isSuccess = true;
+
+    array.forEachBlock(0, -1, [&](const TimeSeries::TimeSeriesColumnSpans<Columns>& spans) {
+        for (int row = 0; row < spans.count; ++row, ++index)
+        {
+            for (int column = 0; column < Columns; ++column)
+            {
+                isSuccess &= spans.columns[column][row] == values[index * Columns + column];
+            }
+            isSuccess &= spans.times[row] == timeStart + index * timeStep;
+        }
+    });
+    const double durationRead = std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() - readStart).count();
+    const double dataScale = (rowCount * (Columns + 1) * 8.0) / (1024 * 1024);
+
+    TimeSeries::TimeSeriesMultiColumnArray<Columns, 65536> openArray(timeStep * rowCount);
+    for (int row = 0; row < 1024; ++row)
+    {
+        openArray.append(timeStart + row * timeStep, values + row * Columns);
+    }
+    const size_t openSize = openArray.stats().memorySize;
+    isSuccess &= openArray.blockCount() == 1 && openSize <= 2 * 65536 + 4096;
+
+    std::cout
+        << "Multi column    : " << Columns << " columns, size "
+        << (100.0 * array.dataSize() / separateSize) << "% of separate arrays, open block "
+        << openSize << " bytes" << std::endl
+        << "Time write      : " << durationWrite << "s   Speed : " << (dataScale / durationWrite) << "MB/s"
+        << std::endl
+        << "Time read       : " << durationRead << "s   Speed : " << (dataScale / durationRead) << "MB/s"
         << std::endl;
 
-    if (!result.isSuccess) {
-        std::cout << "Failed: " << result.error << std::endl;
+    if (!isSuccess || index != rowCount)
+    {
+        std::cout << "Failed: Multi column read back" << std::endl;
+        return false;
     }
 
-    return result.isSuccess;
+    return true;
+}
+
+bool testQueryExecutor(const double *values, int valueCount)
+{
+    const int sampleCount = std::min(1 << 23, valueCount);
+    const int windowCount = 1024;
+    const TimeSeries::time_s64 timeStart = 55556666;
+    const TimeSeries::time_s64 timeStep = 155;
+
+    TimeSeries::TimeSeriesArray<65536, true> array(timeStep * sampleCount * 2);
+    for (int index = 0; index < sampleCount; ++index)
+    {
+        array.append(timeStart + index * timeStep, values[index]);
+    }
+
+    TimeSeries::TimeSeriesQueryExecutor<65536, true> executor(std::max(2u, std::thread::hardware_concurrency()));
+    const TimeSeries::TimeSeriesQueryOptions batch(TimeSeries::TimeSeriesQueryPriority::Batch);
+    std::atomic<bool> isWriting(true);
+    bool isSuccess = true;
+
+    std::thread writer([&]() {
+        for (int index = sampleCount; index < sampleCount * 2 && isWriting.load(std::memory_order_relaxed); ++index)
+        {
+            array.append(timeStart + index * timeStep, values[index % valueCount]);
+        }
+    });
+
+    std::vector<std::future<TimeSeries::TimeSeriesQueryResult<TimeSeries::TimeSeriesAggregate>>> reports;
+    for (int index = 0; index < 16; ++index)
+    {
+        reports.push_back(executor.aggregate(array, 0, -1, batch));
+    }
+
+    std::vector<double> latency;
+    for (int index = 0; index < 256; ++index)
+    {
+        const int windowIndex = (index * 7919) % (sampleCount - windowCount);
+        const TimeSeries::time_s64 beginTime = timeStart + windowIndex * timeStep;
+        const auto result = executor.aggregate(array, beginTime, beginTime + (windowCount - 1) * timeStep).get();
+
+        latency.push_back((result.stats.queueTime + result.stats.runTime) * 1e6);
+        isSuccess &= result.stats.status == TimeSeries::TimeSeriesQueryStatus::Completed &&
+                     result.value.count == static_cast<size_t>(windowCount);
+    }
+
+    TimeSeries::TimeSeriesCancellation cancellation;
+    cancellation.cancel();
+    isSuccess &= executor.range(array, 0, -1, TimeSeries::TimeSeriesQueryOptions(
+                    TimeSeries::TimeSeriesQueryPriority::Batch, -1, cancellation)).get().stats.status ==
+                 TimeSeries::TimeSeriesQueryStatus::Cancelled;
+    isSuccess &= executor.range(array, 0, -1, TimeSeries::TimeSeriesQueryOptions(
+                    TimeSeries::TimeSeriesQueryPriority::Interactive, 0)).get().stats.status ==
+                 TimeSeries::TimeSeriesQueryStatus::DeadlineExceeded;
+
+    for (auto& report : reports)
+    {
+        isSuccess &= report.get().value.count >= static_cast<size_t>(sampleCount);
+    }
+
+    isWriting = false;
+    writer.join();
+    std::sort(latency.begin(), latency.end());
+
+    std::cout
+        << "Query latency   : p50 " << latency[latency.size() / 2] << "us   p99 "
+        << latency[latency.size() * 99 / 100] << "us   under 16 concurrent reports" << std::endl;
+
+    if (!isSuccess)
+    {
+        std::cout << "Failed: Query executor results" << std::endl;
+    }
+
+    return isSuccess;
+}
+
+bool testSharedMemory(const double *values, int valueCount)
+{
+    const char* sharedName = "/timeseriesarray_publish";
+    const int sampleCount = std::min(1 << 23, valueCount);
+    const int checkCount = std::min(1 << 18, sampleCount);
+    const int halfCount = checkCount / 2;
+    const TimeSeries::time_s64 timeStart = 55556666;
+    const TimeSeries::time_s64 timeStep = 155;
+
+    std::vector<TimeSeries::time_s64> times(sampleCount);
+    for (int index = 0; index < sampleCount; ++index)
+    {
+        times[index] = timeStart + index * timeStep;
+    }
+
+    double durations[3];
+    for (int publishInterval = 0; publishInterval < 3; ++publishInterval)
+    {
+        TimeSeries::TimeSeriesArray<65536, true> array(timeStep * sampleCount);
+        if (publishInterval > 0)
+        {
+            array.enableSharedMemory(sharedName, 256, publishInterval == 1 ? 1 : 1024);
+        }
+
+        const auto durationStart = std::chrono::steady_clock::now();
+        for (int index = 0; index < sampleCount; ++index)
+        {
+            array.append(times[index], values[index]);
+        }
+        durations[publishInterval] = std::chrono::duration<double>(
+                                     std::chrono::steady_clock::now() - durationStart).count();
+    }
+
+    TimeSeries::TimeSeriesArray<65536, true> array(timeStep * checkCount);
+    TimeSeries::TimeSeriesSharedMemoryReader<65536, true> reader;
+    bool isSuccess = array.enableSharedMemory(sharedName, 256) && reader.attach(sharedName);
+
+    const auto readBack = [&]() {
+        reader.refresh();
+        int index = 0;
+        for (auto iter = reader.iter(); isSuccess && iter.isValid(); iter.next(), ++index)
+        {
+            isSuccess &= iter.time() == times[index] && iter.value() == values[index];
+        }
+        return index;
+    };
+
+    isSuccess &= array.load(times.data() + halfCount, values + halfCount, checkCount - halfCount - 2);
+    array.append(times[checkCount - 2], values[checkCount - 2]);
+    reader.refresh();
+    isSuccess &= reader.iter().isValid() && reader.iter().time() == times[halfCount];
+
+    isSuccess &= array.load(times.data(), values, halfCount);
+    array.append(times[checkCount - 1], values[checkCount - 1]);
+    isSuccess &= readBack() == checkCount - 1;
+
+    array.publishSharedMemory();
+    isSuccess &= readBack() == checkCount;
+    array.disableSharedMemory();
+
+    std::cout
+        << "Shared memory   : write " << durations[0] << "s, publish every sample " << durations[1]
+        << "s, every 1024 samples " << durations[2] << "s" << std::endl;
+
+    if (!isSuccess)
+    {
+        std::cout << "Failed: Shared memory publish" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool testBulkLoad(const double *values, int valueCount)
+{
+    const int sampleCount = std::min(1 << 23, valueCount);
+    const int halfCount = sampleCount / 2;
+    const TimeSeries::time_s64 timeStart = 55556666;
+    const TimeSeries::time_s64 timeStep = 155;
+
+    std::vector<TimeSeries::time_s64> times(sampleCount);
+    for (int index = 0; index < sampleCount; ++index)
+    {
+        times[index] = timeStart + index * timeStep;
+    }
+
+    TimeSeries::TimeSeriesArray<65536, true> array(timeStep * sampleCount);
+
+    const auto durationStart = std::chrono::steady_clock::now();
+    bool isSuccess = array.load(times.data() + halfCount, values + halfCount, sampleCount - halfCount);
+    isSuccess &= array.load(times.data(), values, halfCount);
+    const double duration = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - durationStart).count();
+
+    isSuccess &= !array.load(times.data(), values, 1);
+    isSuccess &= array.count() == static_cast<size_t>(sampleCount);
+
+    const TimeSeries::time_s64 expiredTime = times[sampleCount - 1] - timeStep * sampleCount;
+    isSuccess &= !array.load(&expiredTime, values, 1);
+
+    {
+        TimeSeries::TimeSeriesArray<65536, true> budgetArray(timeStep * sampleCount);
+        isSuccess &= budgetArray.load(times.data() + halfCount, values + halfCount, sampleCount - halfCount);
+        budgetArray.setMemoryBudget(budgetArray.dataSize() / 2);
+        isSuccess &= !budgetArray.load(times.data(), values, halfCount);
+        budgetArray.setMemoryBudget(0);
+        isSuccess &= !budgetArray.load(times.data(), values, halfCount);
+        isSuccess &= budgetArray.count() < static_cast<size_t>(sampleCount - halfCount);
+    }
+
+    {
+        const char* logPath = "timeseriesarray_load.wal";
+        const int logCount = std::min(1 << 18, halfCount);
+        std::remove(logPath);
+
+        TimeSeries::TimeSeriesArray<4096, true> logArray(timeStep * sampleCount);
+        isSuccess &= logArray.enableWriteAheadLog(logPath);
+        isSuccess &= logArray.load(times.data() + logCount, values + logCount, logCount);
+        isSuccess &= logArray.load(times.data(), values, logCount);
+        isSuccess &= logArray.flushWriteAheadLog();
+        logArray.disableWriteAheadLog();
+
+        TimeSeries::TimeSeriesArray<4096, true> replayArray(timeStep * sampleCount);
+        isSuccess &= replayArray.enableWriteAheadLog(logPath);
+        replayArray.disableWriteAheadLog();
+        isSuccess &= replayArray.count() == static_cast<size_t>(2 * logCount);
+        isSuccess &= replayArray.iter().time() == times[0];
+        std::remove(logPath);
+    }
+
+    std::vector<TimeSeries::time_s64> pageTimes(4096);
+    std::vector<double> pageValues(4096);
+    int index = 0;
+    while (isSuccess && index < sampleCount)
+    {
+        const int readCount = array.read(index, pageTimes.data(), pageValues.data(), 4096);
+        isSuccess &= readCount > 0;
+        for (int page = 0; page < readCount; ++page, ++index)
+        {
+            isSuccess &= pageTimes[page] == times[index] && pageValues[page] == values[index];
+        }
+    }
+
+    std::cout
+        << "Time bulk load  : " << duration << "s   Speed : "
+        << ((sampleCount * 16.0) / (1024 * 1024) / duration) << "MB/s" << std::endl;
+
+    if (!isSuccess)
+    {
+        std::cout << "Failed: Bulk load read back" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool testCrossQuery(const double *values, int valueCount)
+{
+    const int seriesCount = 1024;
+    const int sampleCount = std::min(1 << 23, valueCount) / seriesCount;
+    const TimeSeries::time_s64 timeStart = 55556666;
+    const TimeSeries::time_s64 timeStep = 155;
+    const int topCount = 20;
+
+    std::vector<std::unique_ptr<TimeSeries::TimeSeriesArray<4096, true>>> arrays;
+    TimeSeries::TimeSeriesCrossQuery<4096, true> query;
+    for (int series = 0; series < seriesCount; ++series)
+    {
+        arrays.emplace_back(new TimeSeries::TimeSeriesArray<4096, true>(timeStep * sampleCount));
+        for (int index = 0; index < sampleCount; ++index)
+        {
+            arrays.back()->append(timeStart + index * timeStep, values[series * sampleCount + index] * (1 + series));
+        }
+        query.addSeries(arrays.back().get(), series % 2 ? "odd" : "even");
+    }
+
+    const TimeSeries::time_s64 beginTime = timeStart + (sampleCount / 4) * timeStep;
+    const TimeSeries::time_s64 endTime = timeStart + (sampleCount * 3 / 4) * timeStep;
+
+    const auto scanStart = std::chrono::steady_clock::now();
+    std::vector<double> maxValues;
+    for (const auto& array : arrays)
+    {
+        double maxValue = -std::numeric_limits<double>::infinity();
+        for (auto iter = array->iter(); iter.isValid(); iter.next())
+        {
+            if (iter.time() >= beginTime && iter.time() <= endTime)
+            {
+                maxValue = std::max(maxValue, iter.value());
+            }
+        }
+        maxValues.push_back(maxValue);
+    }
+    const double durationScan = std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() - scanStart).count();
+
+    const auto queryStart = std::chrono::steady_clock::now();
+    const auto ranked = query.topK(topCount, TimeSeries::TimeSeriesRankBy::Max, beginTime, endTime);
+    const double durationQuery = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - queryStart).count();
+    const auto stats = query.stats();
+
+    std::sort(maxValues.begin(), maxValues.end(), std::greater<double>());
+    bool isSuccess = ranked.size() == static_cast<size_t>(topCount);
+    for (size_t index = 0; isSuccess && index < ranked.size(); ++index)
+    {
+        isSuccess &= ranked[index].value == maxValues[index];
+    }
+
+    const auto groups = query.groupBy(beginTime, endTime);
+    const auto total = query.sum(beginTime, endTime);
+    isSuccess &= groups.size() == 2 && groups.at("odd").count + groups.at("even").count == total.count;
+
+    std::cout
+        << "Cross series    : top " << topCount << " of " << seriesCount << " series, "
+        << stats.prunedSeriesCount << " pruned, " << stats.summaryBlockCount << " summarized, "
+        << stats.decodedBlockCount << " decoded blocks" << std::endl
+        << "Time top-k      : " << durationQuery << "s   Full scan : " << durationScan << "s" << std::endl;
+
+    if (!isSuccess)
+    {
+        std::cout << "Failed: Cross series top-k" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool testResample(const double *values, int valueCount)
+{
+    const int sampleCount = std::min(1 << 23, valueCount);
+    const TimeSeries::time_s64 timeStart = 55556666;
+    const TimeSeries::time_s64 timeStep = 155;
+    const TimeSeries::time_s64 cellStep = timeStep * 16;
+
+    TimeSeries::TimeSeriesArray<65536, true> array(timeStep * sampleCount);
+    for (int index = 0; index < sampleCount; ++index)
+    {
+        array.append(timeStart + index * timeStep, values[index]);
+    }
+
+    const TimeSeries::time_s64 endTime = timeStart + sampleCount * timeStep;
+    std::vector<double> cells((endTime - timeStart + cellStep - 1) / cellStep);
+
+    const auto durationStart = std::chrono::steady_clock::now();
+    const size_t cellCount = array.resample(timeStart, endTime, cellStep, TimeSeries::TimeSeriesFill::Linear,
+                                            TimeSeries::TimeSeriesCellAggregate::Mean, cells.data());
+    const double duration = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - durationStart).count();
+
+    bool isSuccess = cellCount == cells.size();
+    for (size_t cell = 0; isSuccess && cell < cellCount; cell += cellCount / 64)
+    {
+        const TimeSeries::time_s64 cellBegin = timeStart + static_cast<TimeSeries::time_s64>(cell) * cellStep;
+        const double expectedValue = array.aggregate(cellBegin, cellBegin + cellStep - 1).mean();
+        isSuccess &= std::fabs(cells[cell] - expectedValue) <= 1e-9 * std::fabs(expectedValue);
+    }
+
+    std::cout
+        << "Time resample   : " << duration << "s   Speed : "
+        << ((sampleCount * 16.0) / (1024 * 1024) / duration) << "MB/s" << std::endl;
+
+    if (!isSuccess)
+    {
+        std::cout << "Failed: Resample" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool testCursor(const double *values, int valueCount)
+{
+    const int sampleCount = std::min(1 << 23, valueCount);
+    const int pageSize = 10000;
+    const TimeSeries::time_s64 timeStart = 55556666;
+    const TimeSeries::time_s64 timeStep = 155;
+
+    TimeSeries::TimeSeriesArray<65536, true> array(timeStep * sampleCount);
+    for (int index = 0; index < sampleCount; ++index)
+    {
+        array.append(timeStart + index * timeStep, values[index]);
+    }
+
+    std::vector<TimeSeries::time_s64> times(pageSize);
+    std::vector<double> pageValues(pageSize);
+    std::string token = array.cursor(timeStart).toToken();
+    int index = 0;
+    int pageCount = 0;
+    bool isSuccess = true;
+
+    const auto durationStart = std::chrono::steady_clock::now();
+    while (isSuccess)
+    {
+        TimeSeries::TimeSeriesCursor cursor;
+        isSuccess &= TimeSeries::TimeSeriesCursor::fromToken(token, cursor);
+
+        const int readCount = array.read(cursor, times.data(), pageValues.data(), pageSize);
+        for (int page = 0; page < readCount; ++page, ++index)
+        {
+            isSuccess &= times[page] == timeStart + index * timeStep && pageValues[page] == values[index];
+        }
+
+        isSuccess &= !cursor.isExpired;
+        token = cursor.toToken();
+        ++pageCount;
+
+        if (cursor.isAtEnd)
+        {
+            break;
+        }
+    }
+    const double duration = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - durationStart).count();
+
+    std::cout
+        << "Time cursor     : " << duration << "s   Speed : "
+        << ((sampleCount * 16.0) / (1024 * 1024) / duration) << "MB/s   " << pageCount << " pages" << std::endl;
+
+    if (!isSuccess || index != sampleCount)
+    {
+        std::cout << "Failed: Cursor pages" << std::endl;
+        return false;
+    }
+
+    return true;
 }
 
 } // Unnamed namespace
@@ -287,6 +1832,13 @@ int main(int argc, char **argv) {
         values[index] = value;
     }
 
+#ifdef TIME_SERIES_TRACE
+    if (argc > 1)
+    {
+        TimeSeries::TimeSeriesTrace::enable();
+    }
+#endif
+
     std::cout << std::endl << "Execute tests.." << std::endl;
 
     const DataType dataTypes[] =
@@ -351,6 +1903,34 @@ int main(int argc, char **argv) {
         testFailed |= !test<false>(dataType, values, valueCount);
     }
 
+    std::cout << std::endl;
+    testFailed |= !testBlockCache();
+    testFailed |= !testWriteAheadLog();
+    testFailed |= !testColdTier(values, valueCount);
+    testFailed |= !testRunLength<1024>();
+    testFailed |= !testRunLength<262144>();
+    testFailed |= !testPipeline();
+    testFailed |= !testErrorBound(values, valueCount);
+    testFailed |= !testBlockDirectory<true>(values, valueCount);
+    testFailed |= !testBlockDirectory<false>(values, valueCount);
+    testFailed |= !testShardedIngest(values, valueCount);
+    testFailed |= !testMultiColumn(values, valueCount);
+    testFailed |= !testQueryExecutor(values, valueCount);
+    testFailed |= !testSharedMemory(values, valueCount);
+    testFailed |= !testBulkLoad(values, valueCount);
+    testFailed |= !testCrossQuery(values, valueCount);
+    testFailed |= !testResample(values, valueCount);
+    testFailed |= !testCursor(values, valueCount);
+
+#ifdef TIME_SERIES_TRACE
+    if (argc > 1)
+    {
+        std::ofstream traceFile(argv[1]);
+        const size_t eventCount = TimeSeries::TimeSeriesTrace::writeChromeTrace(traceFile);
+        std::cout << "Trace events    : " << eventCount << " written to " << argv[1] << std::endl;
+    }
+#endif
+
     delete[] values;
     return testFailed;
 }